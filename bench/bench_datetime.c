@@ -0,0 +1,182 @@
+// Micro-benchmark: DateTime_ParseRFC3339 vs the old setenv("TZ")/mktime
+// parser, over the dateTime strings of the resources/*.json fixtures
+// replicated up to BENCH_EVENTS events (two timestamps per event).
+//
+//   cmake -B build -DFELLA_BUILD_APP=OFF -DFELLA_BUILD_TESTS=OFF
+//         -DFELLA_BUILD_BENCH=ON
+//   cmake --build build && ./build/bench_datetime [fixture.json ...]
+//
+// Without arguments it reads the fixtures from the source tree
+// (BENCH_RESOURCES_DIR, set by CMake), so it runs from any directory.
+
+#include "cJSON.h"
+#include "datetime.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_EVENTS 100000
+
+// The parser events.c used before DateTime_ParseRFC3339, kept verbatim for
+// comparison.
+static time_t legacy_parse_datetime(const char *s) {
+  struct tm t = {0};
+  int tzOffsetMinutes = 0;
+  sscanf(s, "%d-%d-%dT%d:%d:%d", &t.tm_year, &t.tm_mon, &t.tm_mday, &t.tm_hour,
+         &t.tm_min, &t.tm_sec);
+  t.tm_year -= 1900;
+  t.tm_mon -= 1;
+  t.tm_isdst = -1;
+
+  const char *tz = s + 19;
+  if (*tz == '.') {
+    while (*tz && *tz != '+' && *tz != '-' && *tz != 'Z')
+      tz++;
+  }
+  if (*tz == 'Z') {
+    tzOffsetMinutes = 0;
+  } else if (*tz == '+' || *tz == '-') {
+    int sign = (*tz == '+') ? 1 : -1;
+    int tzh = 0, tzm = 0;
+    sscanf(tz + 1, "%d:%d", &tzh, &tzm);
+    tzOffsetMinutes = sign * (tzh * 60 + tzm);
+  }
+
+  char *old_tz = getenv("TZ");
+  char saved_tz[256] = "";
+  if (old_tz)
+    strncpy(saved_tz, old_tz, sizeof(saved_tz) - 1);
+  setenv("TZ", "UTC", 1);
+  tzset();
+  time_t utc = mktime(&t);
+  if (old_tz)
+    setenv("TZ", saved_tz, 1);
+  else
+    unsetenv("TZ");
+  tzset();
+
+  utc -= tzOffsetMinutes * 60;
+  return utc;
+}
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char *read_file(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  long fsize = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *buf = malloc(fsize + 1);
+  if (!buf) {
+    fclose(f);
+    return NULL;
+  }
+  size_t nread = fread(buf, 1, fsize, f);
+  buf[nread] = '\0';
+  fclose(f);
+  return buf;
+}
+
+// Append every start/end dateTime string found in a fixture
+static int collect_timestamps(const char *path, char ***list, int count,
+                              int *cap) {
+  char *json = read_file(path);
+  if (!json) {
+    fprintf(stderr, "Could not open %s\n", path);
+    return count;
+  }
+  cJSON *root = cJSON_Parse(json);
+  free(json);
+  const cJSON *items = cJSON_GetObjectItemCaseSensitive(root, "items");
+  const cJSON *item = NULL;
+  cJSON_ArrayForEach(item, items) {
+    const char *keys[2] = {"start", "end"};
+    for (int k = 0; k < 2; k++) {
+      const cJSON *obj = cJSON_GetObjectItemCaseSensitive(item, keys[k]);
+      const cJSON *dt = cJSON_GetObjectItemCaseSensitive(obj, "dateTime");
+      if (!cJSON_IsString(dt) || !dt->valuestring)
+        continue;
+      if (count == *cap) {
+        *cap = *cap ? *cap * 2 : 16;
+        *list = realloc(*list, (size_t)*cap * sizeof(char *));
+      }
+      (*list)[count++] = strdup(dt->valuestring);
+    }
+  }
+  cJSON_Delete(root);
+  return count;
+}
+
+#ifndef BENCH_RESOURCES_DIR
+#define BENCH_RESOURCES_DIR "resources"
+#endif
+
+int main(int argc, char **argv) {
+  const char *defaults[] = {BENCH_RESOURCES_DIR "/work-entries.json",
+                            BENCH_RESOURCES_DIR "/private-entries.json"};
+  const char **paths = argc > 1 ? (const char **)(argv + 1) : defaults;
+  int npaths = argc > 1 ? argc - 1 : 2;
+
+  char **unique = NULL;
+  int nunique = 0, cap = 0;
+  for (int i = 0; i < npaths; i++)
+    nunique = collect_timestamps(paths[i], &unique, nunique, &cap);
+  if (nunique == 0) {
+    fprintf(stderr, "No dateTime values found\n");
+    return 1;
+  }
+
+  int n = BENCH_EVENTS * 2;
+  const char **inputs = malloc((size_t)n * sizeof(char *));
+  for (int i = 0; i < n; i++)
+    inputs[i] = unique[i % nunique];
+
+  // Verify both parsers agree before timing them
+  for (int i = 0; i < nunique; i++) {
+    time_t fast = 0;
+    DateTime_ParseRFC3339(unique[i], &fast);
+    time_t slow = legacy_parse_datetime(unique[i]);
+    if (fast != slow) {
+      fprintf(stderr, "Mismatch on %s: %ld vs %ld\n", unique[i], (long)fast,
+              (long)slow);
+      return 1;
+    }
+  }
+
+  volatile time_t sink = 0;
+
+  double t0 = now_seconds();
+  for (int i = 0; i < n; i++)
+    sink += legacy_parse_datetime(inputs[i]);
+  double legacy = now_seconds() - t0;
+
+  t0 = now_seconds();
+  for (int i = 0; i < n; i++) {
+    time_t t = 0;
+    DateTime_ParseRFC3339(inputs[i], &t);
+    sink += t;
+  }
+  double fast = now_seconds() - t0;
+
+  printf("%d events (%d timestamps from %d fixture values)\n", BENCH_EVENTS, n,
+         nunique);
+  printf("  legacy setenv/mktime: %8.2f ms  %10.0f ts/s\n", legacy * 1e3,
+         n / legacy);
+  printf("  DateTime_ParseRFC3339: %7.2f ms  %10.0f ts/s\n", fast * 1e3,
+         n / fast);
+  printf("  speedup: %.1fx\n", legacy / fast);
+
+  for (int i = 0; i < nunique; i++)
+    free(unique[i]);
+  free(unique);
+  free(inputs);
+  return 0;
+}
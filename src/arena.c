@@ -0,0 +1,94 @@
+#include "arena.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGN 16
+
+struct ArenaBlock {
+  ArenaBlock *next;
+  size_t used;
+  size_t capacity;
+  // Payload follows the header, aligned to ARENA_ALIGN
+};
+
+#define ARENA_HEADER_SIZE                                                      \
+  ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+static uint8_t *block_data(ArenaBlock *b) {
+  return (uint8_t *)b + ARENA_HEADER_SIZE;
+}
+
+void *Arena_Push(Arena *arena, size_t size) {
+  size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+  if (size == 0)
+    size = ARENA_ALIGN;
+
+  ArenaBlock *b = arena->head;
+  if (!b || b->capacity - b->used < size) {
+    size_t cap = arena->blockSize ? arena->blockSize : ARENA_DEFAULT_BLOCK_SIZE;
+    bool oversized = size > cap / 2;
+    if (cap < size)
+      cap = size;
+    // calloc gives zeroed memory; Arena_Reset re-zeroes what it rewinds
+    b = calloc(1, ARENA_HEADER_SIZE + cap);
+    if (!b)
+      return NULL;
+    b->capacity = cap;
+    if (oversized && arena->head) {
+      // Give big allocations their own block behind the head so the
+      // remaining space in the current block stays usable
+      b->next = arena->head->next;
+      arena->head->next = b;
+    } else {
+      b->next = arena->head;
+      arena->head = b;
+    }
+  }
+
+  void *p = block_data(b) + b->used;
+  b->used += size;
+  return p;
+}
+
+char *Arena_PushString(Arena *arena, const char *s, size_t len) {
+  char *p = Arena_Push(arena, len + 1);
+  if (!p)
+    return NULL;
+  memcpy(p, s, len);
+  return p;
+}
+
+void Arena_Release(Arena *arena) {
+  ArenaBlock *b = arena->head;
+  while (b) {
+    ArenaBlock *next = b->next;
+    free(b);
+    b = next;
+  }
+  arena->head = NULL;
+}
+
+void Arena_Reset(Arena *arena) {
+  ArenaBlock *head = arena->head;
+  if (!head)
+    return;
+  ArenaBlock *b = head->next;
+  while (b) {
+    ArenaBlock *next = b->next;
+    free(b);
+    b = next;
+  }
+  memset(block_data(head), 0, head->used);
+  head->used = 0;
+  head->next = NULL;
+}
+
+size_t Arena_BytesUsed(const Arena *arena) {
+  size_t total = 0;
+  for (const ArenaBlock *b = arena->head; b; b = b->next)
+    total += b->used;
+  return total;
+}
@@ -0,0 +1,28 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+// Region allocator: allocations are bump-pointer pushes into a chain of
+// blocks and are only ever freed all at once with Arena_Release.
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+  ArenaBlock *head;
+  size_t blockSize; // 0 = ARENA_DEFAULT_BLOCK_SIZE
+} Arena;
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+// Returns zeroed, 16-byte aligned memory, or NULL on allocation failure.
+void *Arena_Push(Arena *arena, size_t size);
+// Copies len bytes of s and NUL-terminates the copy.
+char *Arena_PushString(Arena *arena, const char *s, size_t len);
+void Arena_Release(Arena *arena);
+// Frees all blocks but the current one and rewinds it, for arenas refilled
+// over and over (per-frame scratch). Memory pushed afterwards is zeroed too.
+void Arena_Reset(Arena *arena);
+// Bytes handed out since the last release (including alignment padding)
+size_t Arena_BytesUsed(const Arena *arena);
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "clay.h"
 #include "theme.h"
+#include "datetime.h"
 #include "events.h"
 
 #include <stdio.h>
@@ -26,37 +27,50 @@
 typedef enum { PAGE_CALENDAR, PAGE_SETTINGS, PAGE_ABOUT } AppPage;
 static AppPage g_currentPage = PAGE_CALENDAR;
 
-// ── Static string buffers for Clay text ──────────────────────────────────────
-// Clay_String.chars must remain valid for the frame; use static buffers.
-#define CAL_MAX_EVT_TITLE_BUFS 256
-#define CAL_STR_BUF_LEN CAL_DESC_LEN
-static char g_evtTitleBuf[CAL_MAX_EVT_TITLE_BUFS][CAL_STR_BUF_LEN];
-static int  g_evtTitleBufIdx = 0;
+// ── Strings for Clay text ────────────────────────────────────────────────────
+// Clay_String.chars must stay valid until the frame is drawn. Event titles
+// are referenced in the event store as they are; text made for one frame
+// goes into g_frameStrings, rewound at the start of each Calendar_Render.
+#define CAL_TIME_STR_LEN 32
+static Arena g_frameStrings;
 
-static Clay_String cal_make_string(const char *s) {
-  int idx = g_evtTitleBufIdx % CAL_MAX_EVT_TITLE_BUFS;
-  strncpy(g_evtTitleBuf[idx], s, CAL_STR_BUF_LEN - 1);
-  g_evtTitleBuf[idx][CAL_STR_BUF_LEN - 1] = '\0';
-  g_evtTitleBufIdx++;
-  return (Clay_String){.length = (int32_t)strlen(g_evtTitleBuf[idx]),
-                       .chars  = g_evtTitleBuf[idx]};
+static Clay_String cal_event_title(const CalEvent *ev) {
+  return (Clay_String){.length = ev->summaryLength, .chars = ev->summary};
+}
+
+// Copy s into the frame's strings, for buffers that may change before the
+// frame is drawn
+static Clay_String cal_frame_string(const char *s) {
+  size_t len = strlen(s);
+  const char *copy = Arena_PushString(&g_frameStrings, s, len);
+  if (!copy)
+    return CLAY_STRING("");
+  return (Clay_String){.length = (int32_t)len, .chars = copy};
 }
 
 // Format an event's time range into buf. Returns buf.
 static const char *cal_format_event_time(const CalEvent *ev, char *buf,
                                          size_t buflen) {
   if (ev->allDay) {
-    snprintf(buf, buflen, "%04d-%02d-%02d (All day)", ev->startYear,
-             ev->startMon, ev->startMday);
+    int year, mon, mday;
+    DateTime_CivilFromDays(ev->startDay, &year, &mon, &mday);
+    snprintf(buf, buflen, "%04d-%02d-%02d (All day)", year, mon, mday);
   } else {
-    struct tm st = *localtime(&ev->startTime);
-    struct tm et = *localtime(&ev->endTime);
-    snprintf(buf, buflen, "%02d:%02d - %02d:%02d", st.tm_hour, st.tm_min,
-             et.tm_hour, et.tm_min);
+    snprintf(buf, buflen, "%02d:%02d - %02d:%02d", ev->startMinute / 60,
+             ev->startMinute % 60, ev->endMinute / 60, ev->endMinute % 60);
   }
   return buf;
 }
 
+// An event's time range, formatted into the frame's strings
+static Clay_String cal_event_time_string(const CalEvent *ev) {
+  char *buf = Arena_Push(&g_frameStrings, CAL_TIME_STR_LEN);
+  if (!buf)
+    return CLAY_STRING("");
+  cal_format_event_time(ev, buf, CAL_TIME_STR_LEN);
+  return (Clay_String){.length = (int32_t)strlen(buf), .chars = buf};
+}
+
 static Clay_Color Calendar_GetCalendarColor(int calendarIndex) {
   if (calendarIndex >= 0 && calendarIndex < g_calendarCount) {
     LinkedCalendar *cal = &g_calendars[calendarIndex];
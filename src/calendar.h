@@ -2,14 +2,21 @@
 #define CALENDAR_H
 
 #include "cal_common.h"
+#include "day_layout.h"
 #include "raylib.h"
+#include "refresh_scheduler.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 
 static const char *CALENDAR_DAY_NAMES[] = {"Mon", "Tue", "Wed", "Thu",
                                            "Fri", "Sat", "Sun"};
 
+static const char *CALENDAR_MONTH_NAMES[] = {"Jan", "Feb", "Mar", "Apr",
+                                             "May", "Jun", "Jul", "Aug",
+                                             "Sep", "Oct", "Nov", "Dec"};
+
 static const char *HOUR_LABELS[] = {
     "12 AM", "1 AM", "2 AM",  "3 AM",  "4 AM",  "5 AM", "6 AM",  "7 AM",
     "8 AM",  "9 AM", "10 AM", "11 AM", "12 PM", "1 PM", "2 PM",  "3 PM",
@@ -21,6 +28,13 @@ static const char *HOUR_LABELS[] = {
 #define CAL_HEADER_HEIGHT 88.0f
 #define CAL_ALLDAY_HEIGHT 48.0f
 #define CAL_GRID_TOTAL_HEIGHT (24.0f * CAL_HOUR_HEIGHT)
+#define CAL_MIN_EVENT_HEIGHT 16.0f // minimum tap target
+// Grid beyond the ScrollArea's edges still emitted, so rows and events are in
+// place before momentum scrolls them into view
+#define CAL_VIEW_MARGIN (2.0f * CAL_HOUR_HEIGHT)
+// Shortest duration that still overlaps visually, for lane packing
+#define CAL_MIN_EVENT_MINUTES                                                  \
+  ((int)(CAL_MIN_EVENT_HEIGHT / CAL_HOUR_HEIGHT * 60.0f + 0.5f))
 
 // ── Event colors ─────────────────────────────────────────────────────────────
 // colorId -> background + text color pairs
@@ -76,34 +90,23 @@ static EventColors Calendar_ResolveEventColor(const CalEvent *ev) {
   return (EventColors){calColor, textColor};
 }
 
-// Returns whether an all-day event spans the given date (1-indexed month)
-static bool allday_covers(const CalEvent *ev, int year, int mon, int mday) {
-  // Compare date triples: start <= date < end
-  int d = year * 10000 + mon * 100 + mday;
-  int ds = ev->startYear * 10000 + ev->startMon * 100 + ev->startMday;
-  int de = ev->endYear * 10000 + ev->endMon * 100 + ev->endMday;
-  return d >= ds && d < de;
-}
-
-// Returns which weekday column (0=Mon..6=Sun) a UTC time_t falls in,
-// using local time. Returns -1 if outside the displayed week.
-static int timed_event_col(time_t t, struct tm *week_days_tm) {
-  struct tm lt = *localtime(&t);
-  for (int i = 0; i < 7; i++) {
-    if (lt.tm_mday == week_days_tm[i].tm_mday &&
-        lt.tm_mon == week_days_tm[i].tm_mon &&
-        lt.tm_year == week_days_tm[i].tm_year) {
-      return i;
-    }
+// Growable list of event indices bucketed into one day column
+typedef struct {
+  int *items;
+  int count;
+  int capacity;
+} EventBucket;
+
+static void event_bucket_push(EventBucket *b, int eventIndex) {
+  if (b->count == b->capacity) {
+    int newCap = b->capacity ? b->capacity * 2 : 16;
+    int *items = realloc(b->items, (size_t)newCap * sizeof(int));
+    if (!items)
+      return;
+    b->items = items;
+    b->capacity = newCap;
   }
-  return -1;
-}
-
-// Return local fractional hour for a UTC time_t
-static float timed_event_hour(time_t t) {
-  struct tm lt = *localtime(&t);
-  return (float)lt.tm_hour + (float)lt.tm_min / 60.0f +
-         (float)lt.tm_sec / 3600.0f;
+  b->items[b->count++] = eventIndex;
 }
 
 // Transparent background variant for event blocks (~15% opacity)
@@ -117,26 +120,336 @@ static Clay_Color cal_event_bg(Clay_Color c) {
 #include "components/event_detail.h"
 #include "components/menu_item.h"
 #include "components/settings_page.h"
+#include "components/week_nav.h"
+
+// No mouse or arrow key input for this long counts as idle
+#define CAL_IDLE_SECONDS 300.0
+
+// Tell the refresh scheduler how actively the window is in use
+static void Calendar_UpdateActivity(void) {
+  static double lastInput = 0.0;
+  Vector2 mouseDelta = GetMouseDelta();
+  if (mouseDelta.x != 0.0f || mouseDelta.y != 0.0f ||
+      GetMouseWheelMove() != 0.0f || IsMouseButtonDown(0) ||
+      IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_RIGHT))
+    lastInput = GetTime();
+
+  RefreshActivity activity = REFRESH_ACTIVE;
+  if (IsWindowMinimized())
+    activity = REFRESH_HIDDEN;
+  else if (!IsWindowFocused() || GetTime() - lastInput > CAL_IDLE_SECONDS)
+    activity = REFRESH_IDLE;
+  RefreshScheduler_SetActivity(activity);
+}
 
-static void Calendar_Render(uint32_t fontId) {
-  // Load events once
-  Calendar_LoadEvents();
+// ── Retained week view ───────────────────────────────────────────────────────
+// The shown week's events bucketed per day, with their lanes, colors and time
+// labels. Rebuilt only when something they derive from changes; frames that
+// only differ in hover, scrolling, popups or the clock reuse the last build.
+typedef struct {
+  const EventStore *store;
+  uint32_t generation; // Also bumped when the store is re-localized
+  int mondayDay;
+  uint64_t calendars; // Hash of the calendars' visibility and colors
+  bool themeDark;
+} WeekViewKey;
+
+// One timed event block, minus its x offset (which tracks the window width)
+typedef struct {
+  EventColors colors;
+  EventLane lane;
+  float yTop;
+  float height;
+  int32_t timeLength;
+  char time[24]; // "HH:MM - HH:MM"
+} TimedEventView;
+
+typedef struct {
+  WeekViewKey key;
+  bool valid;
+  EventBucket timed[7];  // Store indices of each day's timed events
+  EventBucket allday[7]; // ... and of the all-day events covering the day
+  TimedEventView *timedViews[7]; // Parallel to timed[i].items
+  int timedViewCapacity[7];
+  EventColors *alldayColors[7]; // Parallel to allday[i].items
+  int alldayColorCapacity[7];
+  EventLane *packed; // DayLayout_Pack output for one day
+  int packedCapacity;
+} WeekView;
+
+static uint64_t week_view_calendars_hash(void) {
+  uint64_t h = 1469598103934665603ull; // FNV-1a
+  for (int ci = 0; ci < g_calendarCount; ci++) {
+    const LinkedCalendar *cal = &g_calendars[ci];
+    const uint8_t bytes[5] = {cal->visible, cal->colorR, cal->colorG,
+                              cal->colorB, cal->colorA};
+    for (int b = 0; b < 5; b++) {
+      h ^= bytes[b];
+      h *= 1099511628211ull;
+    }
+  }
+  return h ^ (uint64_t)g_calendarCount;
+}
+
+static bool week_view_key_equal(const WeekViewKey *a, const WeekViewKey *b) {
+  return a->store == b->store && a->generation == b->generation &&
+         a->mondayDay == b->mondayDay && a->calendars == b->calendars &&
+         a->themeDark == b->themeDark;
+}
+
+// Grow a per-event array to at least count elements of size bytes
+static bool week_view_reserve(void **items, int *capacity, int count,
+                              size_t size) {
+  if (count <= *capacity)
+    return true;
+  void *grown = realloc(*items, (size_t)count * size);
+  if (!grown)
+    return false;
+  *items = grown;
+  *capacity = count;
+  return true;
+}
+
+// Drop the current build. The next update rebuilds even if the key matches,
+// as it would for a swapped-in store that happens to share the generation.
+static void WeekView_Invalidate(WeekView *view) {
+  view->valid = false;
+  for (int i = 0; i < 7; i++) {
+    view->timed[i].count = 0;
+    view->allday[i].count = 0;
+  }
+}
+
+static void WeekView_Update(WeekView *view, int mondayDay) {
+  WeekViewKey key = {
+      .store = g_eventStore,
+      .generation = g_eventStore->generation,
+      .mondayDay = mondayDay,
+      .calendars = week_view_calendars_hash(),
+      .themeDark = g_themeDark,
+  };
+  if (view->valid && week_view_key_equal(&view->key, &key))
+    return;
+  WeekView_Invalidate(view);
+
+  // Only events overlapping the shown week come back from the index
+  static EventIndexResult weekEvents;
+  weekEvents.count = 0;
+  EventStore_QueryDays(g_eventStore, mondayDay, mondayDay + 7, &weekEvents);
+
+  for (int wi = 0; wi < weekEvents.count; wi++) {
+    int ei = weekEvents.items[wi];
+    const CalEvent *ev = &g_eventStore->items[ei];
+    // The store may predate a reload that dropped calendars. Cached
+    // neighbouring weeks overlap this one at the edges (multi-day events),
+    // so only take Google events from this week's own window.
+    if (ev->calendarIndex >= g_calendarCount ||
+        !g_calendars[ev->calendarIndex].visible ||
+        (ev->window != CAL_WINDOW_ALL && ev->window != mondayDay))
+      continue;
+    if (ev->allDay) {
+      // Covers [startDay, endDay); clip to the displayed week
+      int first = ev->startDay - mondayDay;
+      int last = ev->endDay - mondayDay;
+      if (first < 0)
+        first = 0;
+      if (last > 7)
+        last = 7;
+      for (int i = first; i < last; i++) {
+        event_bucket_push(&view->allday[i], ei);
+      }
+    } else {
+      int col = ev->startDay - mondayDay;
+      if (col >= 0 && col < 7) {
+        event_bucket_push(&view->timed[col], ei);
+      }
+    }
+  }
+
+  for (int i = 0; i < 7; i++) {
+    EventBucket *timed = &view->timed[i];
+    EventBucket *allday = &view->allday[i];
+    // Without room for the derived data the day shows no events, rather
+    // than events drawn from stale entries
+    if (!week_view_reserve((void **)&view->timedViews[i],
+                           &view->timedViewCapacity[i], timed->count,
+                           sizeof(TimedEventView)))
+      timed->count = 0;
+    if (!week_view_reserve((void **)&view->alldayColors[i],
+                           &view->alldayColorCapacity[i], allday->count,
+                           sizeof(EventColors)))
+      allday->count = 0;
+
+    // Side-by-side lanes for overlapping timed events
+    const EventLane *lanes = NULL;
+    if (week_view_reserve((void **)&view->packed, &view->packedCapacity,
+                          timed->count, sizeof(EventLane))) {
+      DayLayout_Pack(g_eventStore, timed->items, timed->count,
+                     CAL_MIN_EVENT_MINUTES, view->packed);
+      lanes = view->packed;
+    }
+    for (int ei = 0; ei < timed->count; ei++) {
+      const CalEvent *ev = &g_eventStore->items[timed->items[ei]];
+      TimedEventView *tv = &view->timedViews[i][ei];
+      tv->colors = Calendar_ResolveEventColor(ev);
+      tv->lane = lanes ? lanes[ei] : (EventLane){0, 1};
+      // Events running past midnight are cut off at the bottom
+      int endMinute = ev->endDay > ev->startDay ? 24 * 60 : ev->endMinute;
+      tv->yTop = (float)ev->startMinute / 60.0f * CAL_HOUR_HEIGHT;
+      tv->height =
+          (float)(endMinute - ev->startMinute) / 60.0f * CAL_HOUR_HEIGHT;
+      if (tv->height < CAL_MIN_EVENT_HEIGHT)
+        tv->height = CAL_MIN_EVENT_HEIGHT;
+      cal_format_event_time(ev, tv->time, sizeof(tv->time));
+      tv->timeLength = (int32_t)strlen(tv->time);
+    }
+    for (int ae = 0; ae < allday->count; ae++) {
+      view->alldayColors[i][ae] =
+          Calendar_ResolveEventColor(&g_eventStore->items[allday->items[ae]]);
+    }
+  }
+
+  view->key = key;
+  view->valid = true;
+}
+
+// ── Selected event ───────────────────────────────────────────────────────────
+// Store indices don't survive a swap, so the open popup remembers its event
+// by calendar and Google event id and looks it up again in the new store
+#define CAL_EVENT_ID_MAX 1024
+
+typedef struct {
+  bool valid; // False for events without an id, which can't be found again
+  CalendarSource source;
+  char calendarId[CAL_CALID_LEN]; // Or filePath, which shares its storage
+  char id[CAL_EVENT_ID_MAX];
+} EventRef;
+
+static void event_ref_set(EventRef *ref, int index) {
+  const CalEvent *ev = &g_eventStore->items[index];
+  const char *id = g_eventStore->details[index].id;
+  ref->valid = id[0] && strlen(id) < sizeof(ref->id) &&
+               ev->calendarIndex >= 0 && ev->calendarIndex < g_calendarCount;
+  if (!ref->valid)
+    return;
+  const LinkedCalendar *cal = &g_calendars[ev->calendarIndex];
+  ref->source = cal->source;
+  memcpy(ref->calendarId, cal->calendarId, sizeof(ref->calendarId));
+  strcpy(ref->id, id);
+}
+
+static bool event_ref_matches(const EventRef *ref, int index) {
+  const CalEvent *ev = &g_eventStore->items[index];
+  if (ev->calendarIndex < 0 || ev->calendarIndex >= g_calendarCount)
+    return false;
+  const LinkedCalendar *cal = &g_calendars[ev->calendarIndex];
+  return cal->source == ref->source &&
+         strcmp(cal->calendarId, ref->calendarId) == 0 &&
+         strcmp(g_eventStore->details[index].id, ref->id) == 0;
+}
 
-  // Reset title buffer index each frame
-  g_evtTitleBufIdx = 0;
+// Store index of ref's event among the shown week's blocks, -1 if it isn't
+// there any more; *elId gets the block's element id
+static int week_view_find(const WeekView *view, const EventRef *ref,
+                          uint32_t *elId) {
+  if (!ref->valid)
+    return -1;
+  for (int i = 0; i < 7; i++) {
+    for (int ei = 0; ei < view->timed[i].count; ei++) {
+      int evtId = view->timed[i].items[ei];
+      if (event_ref_matches(ref, evtId)) {
+        *elId = Clay_GetElementIdWithIndex(CLAY_STRING("TimedEvt"),
+                                           (uint32_t)evtId)
+                    .id;
+        return evtId;
+      }
+    }
+  }
+  for (int i = 0; i < 7; i++) {
+    for (int ae = 0; ae < view->allday[i].count; ae++) {
+      if (event_ref_matches(ref, view->allday[i].items[ae])) {
+        *elId = Clay_GetElementIdWithIndex(CLAY_STRING("AllDayEvtClick"),
+                                           (uint32_t)(ae * 7 + i))
+                    .id;
+        return view->allday[i].items[ae];
+      }
+    }
+  }
+  return -1;
+}
+
+static void Calendar_Render(uint32_t fontId) {
+  // Last frame's strings have been drawn
+  Arena_Reset(&g_frameStrings);
 
   static bool menuOpen = false;
-  static int selectedEvent = -1;         // index into g_events, -1 = none
+  static int selectedEvent = -1;         // index into g_eventStore, -1 = none
   static uint32_t selectedEventElId = 0; // Clay element ID of clicked event
   static bool selectedEventOnLeft =
       true; // true = event is left of midline, popup goes right
+  static EventRef selectedRef; // selectedEvent, across store swaps
+  bool reselect = false;
+  static int weekOffset = 0; // Weeks from this one, changed by WeekNav/arrows
 
-  // Event bucketing arrays — static so previous frame's data is available for
-  // click detection
-  static int colEvents[7][CAL_MAX_EVENTS];
-  static int colEventCount[7];
-  static int alldayEvents[7][CAL_MAX_EVENTS];
-  static int alldayEventCount[7];
+  time_t now = time(NULL);
+  struct tm today_tm = *localtime(&now);
+  int today_hour = today_tm.tm_hour;
+  int today_min = today_tm.tm_min;
+
+  // Rewind to Monday of this week, as a day number
+  int todayDay = (int)DateTime_DaysFromCivil(
+      today_tm.tm_year + 1900, today_tm.tm_mon + 1, today_tm.tm_mday);
+  int thisMonday = todayDay - (today_tm.tm_wday + 6) % 7;
+
+  // Week navigation: arrow keys or the WeekNav buttons
+  if (g_currentPage == PAGE_CALENDAR && !menuOpen) {
+    int step = 0;
+    if (IsKeyPressed(KEY_LEFT))
+      step = -1;
+    if (IsKeyPressed(KEY_RIGHT))
+      step = 1;
+    if (IsMouseButtonPressed(0)) {
+      if (Clay_PointerOver(
+              Clay_GetElementIdWithIndex(CLAY_STRING("WeekNavBtn"), 0)))
+        step = -1;
+      if (Clay_PointerOver(
+              Clay_GetElementIdWithIndex(CLAY_STRING("WeekNavBtn"), 1)))
+        step = -weekOffset;
+      if (Clay_PointerOver(
+              Clay_GetElementIdWithIndex(CLAY_STRING("WeekNavBtn"), 2)))
+        step = 1;
+    }
+    if (step != 0) {
+      weekOffset += step;
+      selectedEvent = -1;
+      selectedEventElId = 0;
+    }
+  }
+  int mondayDay = thisMonday + 7 * weekOffset;
+
+  // Starts the first sync, swaps in finished ones and requests the viewed
+  // week (plus its neighbours) whenever it changes or a poll is due
+  Calendar_UpdateActivity();
+  Calendar_LoadEvents(mondayDay);
+
+  // Static so the previous frame's buckets are available for click detection
+  static WeekView week;
+
+  // A finished sync swaps in a different store, so last frame's store
+  // indices (element ids, buckets, the open popup) no longer mean anything.
+  // The popup stays open if its event is still in the week once rebuilt.
+  // Signing out renumbers the store on screen in place, with the same effect.
+  static const EventStore *lastStore = NULL;
+  static uint32_t lastGeneration = 0;
+  if (g_eventStore != lastStore ||
+      g_eventStore->generation != lastGeneration) {
+    lastStore = g_eventStore;
+    lastGeneration = g_eventStore->generation;
+    WeekView_Invalidate(&week);
+    reselect = selectedEvent >= 0;
+    selectedEvent = -1;
+    selectedEventElId = 0;
+  }
 
   // Toggle menu on hamburger button click
   if (Clay_PointerOver(Clay_GetElementId(CLAY_STRING("HamburgerBtn"))) &&
@@ -194,32 +507,35 @@ static void Calendar_Render(uint32_t fontId) {
     selectedEventElId = 0;
   }
 
-  // Detect clicks on timed event blocks
-  if (!menuOpen && selectedEvent < 0 && IsMouseButtonPressed(0)) {
+  // Detect clicks on timed event blocks (WeekNav floats above them)
+  if (!menuOpen && selectedEvent < 0 && IsMouseButtonPressed(0) &&
+      !Clay_PointerOver(Clay_GetElementId(CLAY_STRING("WeekNav")))) {
     float midX = (float)GetScreenWidth() / 2.0f;
     for (int i = 0; i < 7; i++) {
-      for (int ei = 0; ei < colEventCount[i]; ei++) {
-        int evtId = i * CAL_MAX_EVENTS + ei;
+      for (int ei = 0; ei < week.timed[i].count; ei++) {
+        int evtId = week.timed[i].items[ei];
         Clay_ElementId eid = Clay_GetElementIdWithIndex(CLAY_STRING("TimedEvt"),
                                                         (uint32_t)evtId);
         if (Clay_PointerOver(eid)) {
-          selectedEvent = colEvents[i][ei];
+          selectedEvent = evtId;
           selectedEventElId = eid.id;
           selectedEventOnLeft = (GetMouseX() < (int)midX);
+          event_ref_set(&selectedRef, evtId);
           goto evt_click_done;
         }
       }
     }
     // Detect clicks on all-day event blocks
     for (int i = 0; i < 7; i++) {
-      for (int ae = 0; ae < alldayEventCount[i]; ae++) {
-        int adId = i * CAL_MAX_EVENTS + ae;
+      for (int ae = 0; ae < week.allday[i].count; ae++) {
+        int adId = ae * 7 + i;
         Clay_ElementId eid = Clay_GetElementIdWithIndex(
             CLAY_STRING("AllDayEvtClick"), (uint32_t)adId);
         if (Clay_PointerOver(eid)) {
-          selectedEvent = alldayEvents[i][ae];
+          selectedEvent = week.allday[i].items[ae];
           selectedEventElId = eid.id;
           selectedEventOnLeft = (GetMouseX() < (int)midX);
+          event_ref_set(&selectedRef, selectedEvent);
           goto evt_click_done;
         }
       }
@@ -227,79 +543,67 @@ static void Calendar_Render(uint32_t fontId) {
   evt_click_done:;
   }
 
-  time_t now = time(NULL);
-  struct tm today_tm = *localtime(&now);
-  int today_mday = today_tm.tm_mday;
-  int today_mon = today_tm.tm_mon;
-  int today_year = today_tm.tm_year;
-  int today_hour = today_tm.tm_hour;
-  int today_min = today_tm.tm_min;
-
-  // Rewind to Monday of this week
-  struct tm monday_tm = today_tm;
-  int days_since_monday = (today_tm.tm_wday + 6) % 7;
-  monday_tm.tm_mday -= days_since_monday;
-  mktime(&monday_tm);
+  // Event day/minute fields are precomputed in local time; redo them only if
+  // the zone offset moved (TZ change or DST transition)
+  if (today_tm.tm_gmtoff != g_eventStore->utcOffset)
+    EventStore_Localize(g_eventStore, 0);
+
+  // Month of the week's Thursday (ISO rule) for the WeekNav label
+  static char monthLabel[16];
+  {
+    int year, mon, mday;
+    DateTime_CivilFromDays(mondayDay + 3, &year, &mon, &mday);
+    snprintf(monthLabel, sizeof(monthLabel), "%s %d",
+             CALENDAR_MONTH_NAMES[mon - 1], year);
+  }
 
   // Pre-compute day info
   static char dayNumBufs[7][4];
-  struct tm days[7];
   bool isToday[7];
   for (int i = 0; i < 7; i++) {
-    days[i] = monday_tm;
-    days[i].tm_mday = monday_tm.tm_mday + i;
-    mktime(&days[i]);
-    snprintf(dayNumBufs[i], sizeof(dayNumBufs[i]), "%d", days[i].tm_mday);
-    isToday[i] = (days[i].tm_mday == today_mday &&
-                  days[i].tm_mon == today_mon && days[i].tm_year == today_year);
+    int year, mon, mday;
+    DateTime_CivilFromDays(mondayDay + i, &year, &mon, &mday);
+    snprintf(dayNumBufs[i], sizeof(dayNumBufs[i]), "%d", mday);
+    isToday[i] = (mondayDay + i == todayDay);
   }
 
   // Current time Y offset for the red line
   float timeLineY =
       ((float)today_hour + (float)today_min / 60.0f) * CAL_HOUR_HEIGHT;
 
-  // Find which column is today (for the red line)
-  int todayCol = -1;
-  for (int i = 0; i < 7; i++) {
-    if (isToday[i]) {
-      todayCol = i;
-      break;
+  // Find which column is today (for the red line); out of 0..6 when another
+  // week is shown
+  int todayCol = todayDay - mondayDay;
+
+  WeekView_Update(&week, mondayDay);
+  if (reselect)
+    selectedEvent = week_view_find(&week, &selectedRef, &selectedEventElId);
+  // Only hour rows and events within the scrolled-to part of the grid are
+  // emitted; spacers keep the rows in place. Before the first layout there is
+  // no scroll position yet, so everything is.
+  float viewTop = 0.0f;
+  float viewBottom = CAL_GRID_TOTAL_HEIGHT;
+  {
+    Clay_ScrollContainerData scroll = Clay_GetScrollContainerData(
+        Clay_GetElementId(CLAY_STRING("ScrollArea")));
+    if (scroll.found && scroll.scrollPosition) {
+      viewTop = -scroll.scrollPosition->y - CAL_VIEW_MARGIN;
+      viewBottom = -scroll.scrollPosition->y +
+                   scroll.scrollContainerDimensions.height + CAL_VIEW_MARGIN;
     }
   }
-
-  // ── Bucket timed events per column ─────────────────────────────────────────
-  memset(colEventCount, 0, sizeof(colEventCount));
-  memset(alldayEventCount, 0, sizeof(alldayEventCount));
-
-  for (int ei = 0; ei < g_eventCount; ei++) {
-    const CalEvent *ev = &g_events[ei];
-    if (!g_calendars[ev->calendarIndex].visible)
-      continue;
-    if (ev->allDay) {
-      for (int i = 0; i < 7; i++) {
-        // days[i].tm_mon is 0-based; ev->startMon is 1-based
-        if (allday_covers(ev, days[i].tm_year + 1900, days[i].tm_mon + 1,
-                          days[i].tm_mday)) {
-          alldayEvents[i][alldayEventCount[i]++] = ei;
-        }
-      }
-    } else {
-      int col = timed_event_col(ev->startTime, days);
-      if (col >= 0 && colEventCount[col] < CAL_MAX_EVENTS) {
-        colEvents[col][colEventCount[col]++] = ei;
-      }
-    }
-  }
-
-  // Determine if any column has all-day events (to show the all-day row)
-  bool hasAnyAllday = false;
-  for (int i = 0; i < 7; i++) {
-    if (alldayEventCount[i] > 0) {
-      hasAnyAllday = true;
-      break;
-    }
-  }
-  (void)hasAnyAllday; // always render the all-day row for consistency
+  int firstHour = (int)(viewTop / CAL_HOUR_HEIGHT);
+  int endHour = (int)(viewBottom / CAL_HOUR_HEIGHT) + 1;
+  if (firstHour < 0)
+    firstHour = 0;
+  if (endHour > 24)
+    endHour = 24;
+  if (endHour < firstHour)
+    endHour = firstHour;
+  float hoursAbove = (float)firstHour * CAL_HOUR_HEIGHT;
+
+  // Columns split DayColumnsArea (window minus the hour gutter) evenly
+  float colWidth = ((float)GetScreenWidth() - CAL_GUTTER_WIDTH) / 7.0f;
 
   if (g_currentPage == PAGE_CALENDAR) {
 
@@ -483,12 +787,13 @@ static void Calendar_Render(uint32_t fontId) {
                      .clip = {.horizontal = true},
                      .border = {.color = cal_borderColor, .width = {.left = 1}},
                  }) {
-              for (int ae = 0; ae < alldayEventCount[i]; ae++) {
-                const CalEvent *ev = &g_events[alldayEvents[i][ae]];
-                EventColors ec = Calendar_ResolveEventColor(ev);
-                Clay_String title = cal_make_string(ev->summary);
+              for (int ae = 0; ae < week.allday[i].count; ae++) {
+                const CalEvent *ev =
+                    &g_eventStore->items[week.allday[i].items[ae]];
+                EventColors ec = week.alldayColors[i][ae];
+                Clay_String title = cal_event_title(ev);
 
-                int adId = i * CAL_MAX_EVENTS + ae;
+                int adId = ae * 7 + i;
                 CLAY(CLAY_IDI("AllDayEvtClick", adId),
                      {
                          .layout =
@@ -550,7 +855,12 @@ static void Calendar_Render(uint32_t fontId) {
                            .layoutDirection = CLAY_TOP_TO_BOTTOM,
                        },
                }) {
-            for (int h = 0; h < 24; h++) {
+            CLAY(CLAY_ID("HourLabelSpacer"),
+                 {
+                     .layout = {.sizing = {.height = CLAY_SIZING_FIXED(
+                                               hoursAbove)}},
+                 }) {}
+            for (int h = firstHour; h < endHour; h++) {
               CLAY(CLAY_IDI("HourLabel", h),
                    {
                        .layout =
@@ -599,8 +909,13 @@ static void Calendar_Render(uint32_t fontId) {
                        .border = {.color = cal_borderColor,
                                   .width = {.left = 1}},
                    }) {
-                // 24 hour slots
-                for (int h = 0; h < 24; h++) {
+                // Hour slots in view
+                CLAY(CLAY_IDI("HourSlotSpacer", i),
+                     {
+                         .layout = {.sizing = {.height = CLAY_SIZING_FIXED(
+                                                   hoursAbove)}},
+                     }) {}
+                for (int h = firstHour; h < endHour; h++) {
                   CLAY(CLAY_IDI("HourSlot", i * 24 + h),
                        {
                            .layout =
@@ -616,49 +931,43 @@ static void Calendar_Render(uint32_t fontId) {
               }
 
               // ── Timed event blocks for this column (floating) ──
-              for (int ei = 0; ei < colEventCount[i]; ei++) {
-                const CalEvent *ev = &g_events[colEvents[i][ei]];
-                EventColors ec = Calendar_ResolveEventColor(ev);
-
-                float startHour = timed_event_hour(ev->startTime);
-                float endHour = timed_event_hour(ev->endTime);
-                float yTop = startHour * CAL_HOUR_HEIGHT;
-                float height = (endHour - startHour) * CAL_HOUR_HEIGHT;
-                if (height < 16.0f)
-                  height = 16.0f; // minimum tap target
-
-                Clay_String title = cal_make_string(ev->summary);
-
-                static char timeBuf[64];
-                cal_format_event_time(ev, timeBuf, sizeof(timeBuf));
-                Clay_String time = cal_make_string(timeBuf);
-
-                // Each event block is a floating element attached to
-                // DayColumnsArea. We need its X offset too. We can't easily
-                // get the column's X from Clay at layout time, so we use a
-                // trick: attach to the DayColumnsArea and express X as a
-                // fraction by nesting. Simpler approach: use
-                // CLAY_ATTACH_TO_PARENT (DayColumnsArea) and rely on Clay
-                // knowing the column widths. Since columns are SIZING_GROW
-                // equally, each is 1/7 of the area. We'll use a floating
-                // element per event inside the DayColumnsArea. We need the
-                // actual pixel width of the column — but we can approximate
-                // by attaching to the parent element and computing x as
-                // fraction * parent_width. Clay doesn't expose that
-                // directly, so we use a simpler trick: attach to
-                // DayColumn[i] by ID and float at (0, yTop) with
-                // SIZING_GROW width.
+              for (int ei = 0; ei < week.timed[i].count; ei++) {
+                int evtId = week.timed[i].items[ei];
+                const CalEvent *ev = &g_eventStore->items[evtId];
+                const TimedEventView *tv = &week.timedViews[i][ei];
+                // The open popup is attached to its event's block, so that
+                // one stays even when scrolled away
+                if ((tv->yTop + tv->height < viewTop ||
+                     tv->yTop > viewBottom) &&
+                    evtId != selectedEvent)
+                  continue;
+                EventColors ec = tv->colors;
+                float yTop = tv->yTop;
+                float height = tv->height;
+
+                // Overlapping events share the column in equal lanes
+                float laneFrac = 1.0f / (float)tv->lane.laneCount;
+                float xLeft =
+                    2.0f + (float)tv->lane.lane * colWidth * laneFrac;
+
+                Clay_String title = cal_event_title(ev);
+                Clay_String time = {.length = tv->timeLength,
+                                    .chars = tv->time};
+
+                // Each event block floats on DayColumn[i], attached by ID.
+                // Width is a percentage of the column so it tracks resizes;
+                // the x offset of its lane comes from the even 1/7 split.
 
                 // Use CLAY_ID_LOCAL won't work for floating with
-                // attach-to-element. Use a combined index: col*64 + ei as
-                // the IDI numeric key.
-                int evtId = i * CAL_MAX_EVENTS + ei;
+                // attach-to-element. Each timed event lands in exactly one
+                // column, so its store index is a unique IDI key.
                 CLAY(
                     CLAY_IDI("TimedEvt", evtId),
                     {
                         .layout =
                             {
-                                .sizing = {.width = CLAY_SIZING_GROW(0),
+                                .sizing = {.width =
+                                               CLAY_SIZING_PERCENT(laneFrac),
                                            .height = CLAY_SIZING_FIXED(height)},
                                 .layoutDirection = CLAY_TOP_TO_BOTTOM,
                                 .padding = {4, 4, 4, 4},
@@ -678,7 +987,7 @@ static void Calendar_Render(uint32_t fontId) {
                                     Clay_GetElementIdWithIndex(
                                         CLAY_STRING("DayColumn"), (uint32_t)i)
                                         .id,
-                                .offset = {2, yTop},
+                                .offset = {xLeft, yTop},
                                 .zIndex = 10,
                                 .pointerCaptureMode =
                                     CLAY_POINTER_CAPTURE_MODE_PASSTHROUGH,
@@ -699,7 +1008,7 @@ static void Calendar_Render(uint32_t fontId) {
             }
 
             // ── Current Time Line (floating) ──
-            if (todayCol >= 0) {
+            if (todayCol >= 0 && todayCol < 7) {
               CLAY(CLAY_ID("CurrentTimeLine"),
                    {
                        .layout =
@@ -740,6 +1049,41 @@ static void Calendar_Render(uint32_t fontId) {
       }
     }
 
+    // ── Sync indicator (top right, over the day header) ──
+    if (Calendar_IsSyncing()) {
+      CLAY(CLAY_ID("SyncIndicator"),
+           {
+               .layout =
+                   {
+                       .padding = {10, 10, 4, 4},
+                       .childAlignment = {.y = CLAY_ALIGN_Y_CENTER},
+                   },
+               .backgroundColor = cal_cream,
+               .cornerRadius = CLAY_CORNER_RADIUS(10),
+               .border = {.color = cal_borderColor, .width = CLAY_BORDER_ALL(1)},
+               .floating =
+                   {
+                       .attachTo = CLAY_ATTACH_TO_ROOT,
+                       .attachPoints = {.element = CLAY_ATTACH_POINT_RIGHT_TOP,
+                                        .parent = CLAY_ATTACH_POINT_RIGHT_TOP},
+                       .offset = {-8, 6},
+                       .zIndex = 60,
+                       .pointerCaptureMode =
+                           CLAY_POINTER_CAPTURE_MODE_PASSTHROUGH,
+                   },
+           }) {
+        CLAY_TEXT(CLAY_STRING("Syncing..."),
+                  CLAY_TEXT_CONFIG({
+                      .fontId = fontId,
+                      .fontSize = 13,
+                      .textColor = cal_secondaryText,
+                  }));
+      }
+    }
+
+    // ── Week navigation (bottom right) ──
+    WeekNav(monthLabel, fontId);
+
     // ── Sidebar Menu Overlay ──
     if (menuOpen) {
       // Scrim / backdrop
@@ -801,9 +1145,22 @@ static void Calendar_Render(uint32_t fontId) {
                     }));
         }
 
-        // Calendar rows with checkboxes
-        for (int ci = 0; ci < g_calendarCount; ci++) {
-          CalendarRow(ci, fontId);
+        // Calendar rows with checkboxes; scrolls once the calendar list
+        // outgrows the panel
+        CLAY(CLAY_ID("CalList"),
+             {
+                 .layout =
+                     {
+                         .sizing = {.width = CLAY_SIZING_GROW(0),
+                                    .height = CLAY_SIZING_FIT(0)},
+                         .layoutDirection = CLAY_TOP_TO_BOTTOM,
+                     },
+                 .clip = {.vertical = true,
+                          .childOffset = Clay_GetScrollOffset()},
+             }) {
+          for (int ci = 0; ci < g_calendarCount; ci++) {
+            CalendarRow(ci, fontId);
+          }
         }
 
         // Divider between calendar list and menu items
@@ -824,10 +1181,11 @@ static void Calendar_Render(uint32_t fontId) {
     }
 
     // ── Event Detail Popup (anchored to clicked event) ──
-    if (selectedEvent >= 0 && selectedEvent < g_eventCount &&
+    if (selectedEvent >= 0 && selectedEvent < g_eventStore->count &&
         selectedEventElId != 0) {
-      EventDetail(&g_events[selectedEvent], fontId, selectedEventElId,
-                  selectedEventOnLeft);
+      EventDetail(&g_eventStore->items[selectedEvent],
+                  EventStore_GetDetail(g_eventStore, selectedEvent), fontId,
+                  selectedEventElId, selectedEventOnLeft);
     }
 
   } else if (g_currentPage == PAGE_SETTINGS) {
@@ -26,8 +26,11 @@ static void CalendarRow(int ci, uint32_t fontId) {
        }) {
     CalendarCheckbox(ci, vis, calColor);
 
-    // Calendar name
-    Clay_String calName = cal_make_string(g_calendars[ci].name);
+    // Calendar name; g_calendars only changes between frames
+    Clay_String calName = {
+        .length = (int32_t)strlen(g_calendars[ci].name),
+        .chars  = g_calendars[ci].name,
+    };
     CLAY_TEXT(calName, CLAY_TEXT_CONFIG({
                             .fontId    = fontId,
                             .fontSize  = 16,
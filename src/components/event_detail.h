@@ -3,13 +3,10 @@
 
 #include "cal_common.h"
 
-static void EventDetail(const CalEvent *sel, uint32_t fontId,
-                        uint32_t parentElId, bool onLeft) {
+static void EventDetail(const CalEvent *sel, const CalEventDetail *detail,
+                        uint32_t fontId, uint32_t parentElId, bool onLeft) {
   Clay_Color calColor = Calendar_GetCalendarColor(sel->calendarIndex);
 
-  static char timeBuf[64];
-  cal_format_event_time(sel, timeBuf, sizeof(timeBuf));
-
   const char *calName =
       (sel->calendarIndex >= 0 && sel->calendarIndex < g_calendarCount)
           ? g_calendars[sel->calendarIndex].name
@@ -59,7 +56,7 @@ static void EventDetail(const CalEvent *sel, uint32_t fontId,
          }) {
 
       // Title
-      CLAY_TEXT(cal_make_string(sel->summary),
+      CLAY_TEXT(cal_event_title(sel),
                 CLAY_TEXT_CONFIG({
                     .fontId = fontId,
                     .fontSize = 20,
@@ -68,14 +65,18 @@ static void EventDetail(const CalEvent *sel, uint32_t fontId,
                 }));
 
       // Time
-      CLAY_TEXT(cal_make_string(timeBuf), CLAY_TEXT_CONFIG({
-                                              .fontId = fontId,
-                                              .fontSize = 18,
-                                              .textColor = cal_secondaryText,
-                                          }));
+      CLAY_TEXT(cal_event_time_string(sel),
+                CLAY_TEXT_CONFIG({
+                    .fontId = fontId,
+                    .fontSize = 18,
+                    .textColor = cal_secondaryText,
+                }));
+
+      // Detail strings live in the event store's arena for the whole frame,
+      // so they are referenced directly.
 
       // Location (if present)
-      if (sel->location[0] != '\0') {
+      if (detail->location[0] != '\0') {
         CLAY(CLAY_ID("EvtDetailLocRow"),
              {
                  .layout =
@@ -92,7 +93,11 @@ static void EventDetail(const CalEvent *sel, uint32_t fontId,
                         .fontSize = 18,
                         .textColor = cal_secondaryText,
                     }));
-          CLAY_TEXT(cal_make_string(sel->location),
+          Clay_String location = {
+              .length = (int32_t)strlen(detail->location),
+              .chars = detail->location,
+          };
+          CLAY_TEXT(location,
                     CLAY_TEXT_CONFIG({
                         .fontId = fontId,
                         .fontSize = 16,
@@ -103,8 +108,12 @@ static void EventDetail(const CalEvent *sel, uint32_t fontId,
       }
 
       // Description (if present)
-      if (sel->description[0] != '\0') {
-        CLAY_TEXT(cal_make_string(sel->description),
+      if (detail->description[0] != '\0') {
+        Clay_String description = {
+            .length = (int32_t)strlen(detail->description),
+            .chars = detail->description,
+        };
+        CLAY_TEXT(description,
                   CLAY_TEXT_CONFIG({
                       .fontId = fontId,
                       .fontSize = 18,
@@ -148,11 +157,14 @@ static void EventDetail(const CalEvent *sel, uint32_t fontId,
                             .width = CLAY_BORDER_ALL(1)},
 
              }) {}
-        CLAY_TEXT(cal_make_string(calName), CLAY_TEXT_CONFIG({
-                                                .fontId = fontId,
-                                                .fontSize = 18,
-                                                .textColor = cal_secondaryText,
-                                            }));
+        // g_calendars is only replaced before the next frame's layout
+        Clay_String calNameStr = {.length = (int32_t)strlen(calName),
+                                  .chars = calName};
+        CLAY_TEXT(calNameStr, CLAY_TEXT_CONFIG({
+                                  .fontId = fontId,
+                                  .fontSize = 18,
+                                  .textColor = cal_secondaryText,
+                              }));
       }
     }
   }
@@ -11,51 +11,52 @@
 
 static void SettingsPage_Render(uint32_t fontId) {
   // Poll OAuth server status
-  if (g_authState == AUTH_AWAITING_CODE &&
+  if (GoogleAuth_GetState() == AUTH_AWAITING_CODE &&
       g_oauthServerStatus == OAUTH_SERVER_RECEIVED) {
     if (GoogleAuth_ExchangeCode(g_oauthReceivedCode)) {
       Calendar_ReloadEvents();
     }
     OAuthServer_Stop();
-  } else if (g_authState == AUTH_AWAITING_CODE &&
+  } else if (GoogleAuth_GetState() == AUTH_AWAITING_CODE &&
              g_oauthServerStatus == OAUTH_SERVER_ERROR) {
-    snprintf(g_authErrorMsg, GOOGLE_AUTH_ERR_MAX,
-             "Local OAuth server failed to start");
-    g_authState = AUTH_ERROR;
+    GoogleAuth_SetState(AUTH_ERROR, "Local OAuth server failed to start");
     OAuthServer_Stop();
   }
 
   // Handle button clicks
   if (IsMouseButtonPressed(0)) {
-    if (g_authState == AUTH_READY &&
+    if (GoogleAuth_GetState() == AUTH_READY &&
         Clay_PointerOver(Clay_GetElementId(CLAY_STRING("GoogleConnectBtn")))) {
       if (OAuthServer_Start()) {
         char redirectUri[128];
         OAuthServer_GetRedirectUri(redirectUri, sizeof(redirectUri));
         GoogleAuth_BuildAuthUrlWithRedirect(redirectUri);
         OpenURL(g_authUrl);
-        g_authState = AUTH_AWAITING_CODE;
+        GoogleAuth_SetState(AUTH_AWAITING_CODE, NULL);
       }
     }
-    if (g_authState == AUTH_AUTHENTICATED &&
+    if (GoogleAuth_GetState() == AUTH_AUTHENTICATED &&
         Clay_PointerOver(
             Clay_GetElementId(CLAY_STRING("GoogleDisconnectBtn")))) {
       GoogleAuth_Disconnect();
       Calendar_ReloadEvents();
     }
-    if (g_authState == AUTH_AUTHENTICATED &&
+    if (GoogleAuth_GetState() == AUTH_AUTHENTICATED &&
         Clay_PointerOver(Clay_GetElementId(CLAY_STRING("GoogleRefreshBtn")))) {
-      Calendar_ReloadEvents();
+      // Only the Google calendars; file calendars keep their events
+      for (int ci = 0; ci < g_calendarCount; ci++) {
+        if (g_calendars[ci].source == CAL_SOURCE_GOOGLE)
+          Calendar_ReloadCalendar(ci);
+      }
     }
-    if (g_authState == AUTH_ERROR &&
+    if (GoogleAuth_GetState() == AUTH_ERROR &&
         Clay_PointerOver(Clay_GetElementId(CLAY_STRING("GoogleRetryBtn")))) {
-      g_authState = AUTH_READY;
-      g_authErrorMsg[0] = '\0';
+      GoogleAuth_SetState(AUTH_READY, "");
     }
-    if (g_authState == AUTH_AWAITING_CODE &&
+    if (GoogleAuth_GetState() == AUTH_AWAITING_CODE &&
         Clay_PointerOver(Clay_GetElementId(CLAY_STRING("GoogleCancelBtn")))) {
       OAuthServer_Stop();
-      g_authState = AUTH_READY;
+      GoogleAuth_SetState(AUTH_READY, NULL);
     }
     // Theme toggle
     if (Clay_PointerOver(Clay_GetElementId(CLAY_STRING("ThemeToggleBtn")))) {
@@ -202,7 +203,7 @@ static void SettingsPage_Render(uint32_t fontId) {
                 }));
 
       // ── AUTH_READY: Show connect button ──
-      if (g_authState == AUTH_READY) {
+      if (GoogleAuth_GetState() == AUTH_READY) {
         CLAY(CLAY_ID("GoogleConnectBtn"),
              {
                  .layout =
@@ -230,7 +231,7 @@ static void SettingsPage_Render(uint32_t fontId) {
       }
 
       // ── AUTH_AWAITING_CODE: Waiting for browser authorization ──
-      if (g_authState == AUTH_AWAITING_CODE) {
+      if (GoogleAuth_GetState() == AUTH_AWAITING_CODE) {
         CLAY_TEXT(
             CLAY_STRING("Waiting for authorization... Complete sign-in in your "
                         "browser."),
@@ -266,7 +267,7 @@ static void SettingsPage_Render(uint32_t fontId) {
       }
 
       // ── AUTH_AUTHENTICATED: Connected status + buttons ──
-      if (g_authState == AUTH_AUTHENTICATED) {
+      if (GoogleAuth_GetState() == AUTH_AUTHENTICATED) {
         CLAY(CLAY_ID("GoogleStatusRow"),
              {
                  .layout =
@@ -363,7 +364,7 @@ static void SettingsPage_Render(uint32_t fontId) {
       }
 
       // ── AUTH_ERROR: Error message + retry ──
-      if (g_authState == AUTH_ERROR) {
+      if (GoogleAuth_GetState() == AUTH_ERROR) {
         CLAY_TEXT(CLAY_STRING("Authentication failed:"),
                   CLAY_TEXT_CONFIG({
                       .fontId = fontId,
@@ -371,8 +372,11 @@ static void SettingsPage_Render(uint32_t fontId) {
                       .textColor = g_theme.love,
                   }));
 
-        if (g_authErrorMsg[0] != '\0') {
-          CLAY_TEXT(cal_make_string(g_authErrorMsg),
+        // Snapshot: the refresher and sync worker write it too
+        char authError[GOOGLE_AUTH_ERR_MAX];
+        GoogleAuth_GetError(authError, sizeof(authError));
+        if (authError[0] != '\0') {
+          CLAY_TEXT(cal_frame_string(authError),
                     CLAY_TEXT_CONFIG({
                         .fontId = fontId,
                         .fontSize = 14,
@@ -0,0 +1,68 @@
+#ifndef COMPONENT_WEEK_NAV_H
+#define COMPONENT_WEEK_NAV_H
+
+#include "cal_common.h"
+
+static const char *WEEK_NAV_LABELS[3] = {"<", "Today", ">"};
+
+// Floating pill in the bottom right: previous week, back to this week, next
+// week (WeekNavBtn 0..2), then the month being shown
+static void WeekNav(const char *monthLabel, uint32_t fontId) {
+  CLAY(CLAY_ID("WeekNav"),
+       {
+           .layout =
+               {
+                   .padding = {4, 12, 4, 4},
+                   .childGap = 4,
+                   .childAlignment = {.y = CLAY_ALIGN_Y_CENTER},
+               },
+           .backgroundColor = cal_cream,
+           .cornerRadius = CLAY_CORNER_RADIUS(16),
+           .border = {.color = cal_borderColor, .width = CLAY_BORDER_ALL(1)},
+           .floating =
+               {
+                   .attachTo = CLAY_ATTACH_TO_ROOT,
+                   .attachPoints = {.element = CLAY_ATTACH_POINT_RIGHT_BOTTOM,
+                                    .parent = CLAY_ATTACH_POINT_RIGHT_BOTTOM},
+                   .offset = {-16, -16},
+                   .zIndex = 60,
+               },
+       }) {
+    for (int i = 0; i < 3; i++) {
+      CLAY(CLAY_IDI("WeekNavBtn", i),
+           {
+               .layout =
+                   {
+                       .sizing = {.height = CLAY_SIZING_FIXED(28)},
+                       .padding = {10, 10, 0, 0},
+                       .childAlignment = {.y = CLAY_ALIGN_Y_CENTER},
+                   },
+               .backgroundColor = Clay_Hovered()
+                                      ? cal_hoverBg
+                                      : (Clay_Color){0, 0, 0, 0},
+               .cornerRadius = CLAY_CORNER_RADIUS(14),
+           }) {
+        Clay_String text = {
+            .length = (int32_t)strlen(WEEK_NAV_LABELS[i]),
+            .chars  = WEEK_NAV_LABELS[i],
+        };
+        CLAY_TEXT(text, CLAY_TEXT_CONFIG({
+                            .fontId    = fontId,
+                            .fontSize  = 16,
+                            .textColor = cal_primaryText,
+                        }));
+      }
+    }
+    Clay_String label = {
+        .length = (int32_t)strlen(monthLabel),
+        .chars  = monthLabel,
+    };
+    CLAY_TEXT(label, CLAY_TEXT_CONFIG({
+                         .fontId    = fontId,
+                         .fontSize  = 16,
+                         .textColor = cal_secondaryText,
+                     }));
+  }
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include "datetime.h"
+
+// Read exactly n ASCII digits. Returns -1 if any of them is not a digit.
+static int read_digits(const char *s, int n) {
+  int v = 0;
+  for (int i = 0; i < n; i++) {
+    unsigned d = (unsigned)(s[i] - '0');
+    if (d > 9)
+      return -1;
+    v = v * 10 + (int)d;
+  }
+  return v;
+}
+
+static int days_in_month(int year, int mon) {
+  static const int kDays[12] = {31, 28, 31, 30, 31, 30,
+                                31, 31, 30, 31, 30, 31};
+  if (mon == 2 && (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)))
+    return 29;
+  return kDays[mon - 1];
+}
+
+// Howard Hinnant's days_from_civil: branch-light and exact for all years
+int64_t DateTime_DaysFromCivil(int year, int mon, int mday) {
+  int64_t y = (int64_t)year - (mon <= 2);
+  int64_t era = (y >= 0 ? y : y - 399) / 400;
+  int64_t yoe = y - era * 400;                            // [0, 399]
+  int64_t mp = (mon + 9) % 12;                            // Mar = 0
+  int64_t doy = (153 * mp + 2) / 5 + mday - 1;            // [0, 365]
+  int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;    // [0, 146096]
+  return era * 146097 + doe - 719468;
+}
+
+void DateTime_CivilFromDays(int64_t days, int *year, int *mon, int *mday) {
+  int64_t z = days + 719468;
+  int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+  int64_t doe = z - era * 146097;                         // [0, 146096]
+  int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);  // [0, 365]
+  int64_t mp = (5 * doy + 2) / 153;                       // Mar = 0
+  int d = (int)(doy - (153 * mp + 2) / 5 + 1);
+  int m = (int)(mp < 10 ? mp + 3 : mp - 9);
+  *year = (int)(yoe + era * 400 + (m <= 2));
+  *mon = m;
+  *mday = d;
+}
+
+// "YYYY-MM-DD" prefix shared by both parsers
+static bool parse_date_part(const char *s, int *year, int *mon, int *mday) {
+  int y = read_digits(s, 4);
+  if (y < 0 || s[4] != '-')
+    return false;
+  int m = read_digits(s + 5, 2);
+  if (m < 1 || m > 12 || s[7] != '-')
+    return false;
+  int d = read_digits(s + 8, 2);
+  if (d < 1 || d > days_in_month(y, m))
+    return false;
+  *year = y;
+  *mon = m;
+  *mday = d;
+  return true;
+}
+
+bool DateTime_ParseDate(const char *s, int *year, int *mon, int *mday) {
+  return parse_date_part(s, year, mon, mday);
+}
+
+bool DateTime_ParseRFC3339(const char *s, time_t *out) {
+  int year, mon, mday;
+  if (!parse_date_part(s, &year, &mon, &mday))
+    return false;
+
+  char sep = s[10];
+  if (sep != 'T' && sep != 't' && sep != ' ')
+    return false;
+
+  // "HH:MM:SS"
+  const char *p = s + 11;
+  int hour = read_digits(p, 2);
+  if (hour < 0 || hour > 23 || p[2] != ':')
+    return false;
+  int min = read_digits(p + 3, 2);
+  if (min < 0 || min > 59 || p[5] != ':')
+    return false;
+  int sec = read_digits(p + 6, 2);
+  if (sec < 0 || sec > 60) // 60 = leap second
+    return false;
+  p += 8;
+
+  // Optional fraction, truncated to whole seconds
+  if (*p == '.' || *p == ',') {
+    p++;
+    if ((unsigned)(*p - '0') > 9)
+      return false;
+    while ((unsigned)(*p - '0') <= 9)
+      p++;
+  }
+
+  int offsetSec = 0;
+  if (*p == 'Z' || *p == 'z') {
+    p++;
+  } else if (*p == '+' || *p == '-') {
+    int sign = (*p == '+') ? 1 : -1;
+    p++;
+    int oh = read_digits(p, 2);
+    if (oh < 0 || oh > 23)
+      return false;
+    p += 2;
+    if (*p == ':')
+      p++;
+    int om = read_digits(p, 2);
+    if (om < 0 || om > 59)
+      return false;
+    p += 2;
+    offsetSec = sign * (oh * 3600 + om * 60);
+  }
+
+  int64_t days = DateTime_DaysFromCivil(year, mon, mday);
+  int64_t t = days * 86400 + hour * 3600 + min * 60 + sec;
+  // Offset means "local = UTC + offset"
+  *out = (time_t)(t - offsetSec);
+  return true;
+}
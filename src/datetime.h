@@ -0,0 +1,24 @@
+#ifndef DATETIME_H
+#define DATETIME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+// Days since 1970-01-01 for a proleptic Gregorian date (1-indexed month)
+int64_t DateTime_DaysFromCivil(int year, int mon, int mday);
+
+// Inverse of DateTime_DaysFromCivil
+void DateTime_CivilFromDays(int64_t days, int *year, int *mon, int *mday);
+
+// Parse an RFC3339 / ISO-8601 timestamp into a UTC epoch, e.g.
+//   "2026-02-27T09:00:00-05:00", "2026-02-27T14:00:00.250Z",
+//   "2026-02-27 09:00:00+0100"
+// Fractional seconds are accepted and truncated. A missing offset is read
+// as UTC. Pure integer math: never touches TZ or the C library time zone.
+bool DateTime_ParseRFC3339(const char *s, time_t *out);
+
+// Parse "2026-02-28" -> year/mon/mday (1-indexed month)
+bool DateTime_ParseDate(const char *s, int *year, int *mon, int *mday);
+
+#endif
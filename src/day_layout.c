@@ -0,0 +1,160 @@
+#include "day_layout.h"
+
+#include <stdlib.h>
+
+typedef struct {
+  int start, end; // Minutes from the start of the day
+  int pos;        // Index into the caller's events[] / out[]
+} PackItem;
+
+typedef struct {
+  int end;
+  int lane;
+} ActiveLane;
+
+// Scratch buffers shared by every DayLayout_Pack call (render thread only)
+static PackItem *s_items;
+static ActiveLane *s_active;
+static int *s_free;
+static int s_scratchCap;
+
+static bool ensure_scratch(int n) {
+  if (n <= s_scratchCap)
+    return true;
+  int cap = s_scratchCap ? s_scratchCap : 64;
+  while (cap < n)
+    cap *= 2;
+  PackItem *items = realloc(s_items, (size_t)cap * sizeof(PackItem));
+  if (items)
+    s_items = items;
+  ActiveLane *active = realloc(s_active, (size_t)cap * sizeof(ActiveLane));
+  if (active)
+    s_active = active;
+  int *freeLanes = realloc(s_free, (size_t)cap * sizeof(int));
+  if (freeLanes)
+    s_free = freeLanes;
+  if (!items || !active || !freeLanes)
+    return false;
+  s_scratchCap = cap;
+  return true;
+}
+
+static int compare_items(const void *pa, const void *pb) {
+  const PackItem *a = pa, *b = pb;
+  if (a->start != b->start)
+    return a->start < b->start ? -1 : 1;
+  // Longer events first so they get the leftmost lane
+  if (a->end != b->end)
+    return a->end > b->end ? -1 : 1;
+  return (a->pos > b->pos) - (a->pos < b->pos);
+}
+
+// ── Binary min-heaps ─────────────────────────────────────────────────────────
+static void active_push(ActiveLane *h, int *n, ActiveLane v) {
+  int i = (*n)++;
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (h[parent].end <= v.end)
+      break;
+    h[i] = h[parent];
+    i = parent;
+  }
+  h[i] = v;
+}
+
+static ActiveLane active_pop(ActiveLane *h, int *n) {
+  ActiveLane top = h[0];
+  ActiveLane last = h[--(*n)];
+  int i = 0;
+  for (;;) {
+    int child = 2 * i + 1;
+    if (child >= *n)
+      break;
+    if (child + 1 < *n && h[child + 1].end < h[child].end)
+      child++;
+    if (last.end <= h[child].end)
+      break;
+    h[i] = h[child];
+    i = child;
+  }
+  h[i] = last;
+  return top;
+}
+
+static void lane_push(int *h, int *n, int v) {
+  int i = (*n)++;
+  while (i > 0) {
+    int parent = (i - 1) / 2;
+    if (h[parent] <= v)
+      break;
+    h[i] = h[parent];
+    i = parent;
+  }
+  h[i] = v;
+}
+
+static int lane_pop(int *h, int *n) {
+  int top = h[0];
+  int last = h[--(*n)];
+  int i = 0;
+  for (;;) {
+    int child = 2 * i + 1;
+    if (child >= *n)
+      break;
+    if (child + 1 < *n && h[child + 1] < h[child])
+      child++;
+    if (last <= h[child])
+      break;
+    h[i] = h[child];
+    i = child;
+  }
+  h[i] = last;
+  return top;
+}
+
+void DayLayout_Pack(const EventStore *store, const int *events, int count,
+                    int minMinutes, EventLane *out) {
+  if (!ensure_scratch(count)) {
+    // Fall back to stacking everything full width
+    for (int i = 0; i < count; i++)
+      out[i] = (EventLane){0, 1};
+    return;
+  }
+
+  for (int i = 0; i < count; i++) {
+    const CalEvent *ev = &store->items[events[i]];
+    int start = ev->startMinute;
+    int end = ev->endDay > ev->startDay ? 24 * 60 : ev->endMinute;
+    if (end < start + minMinutes)
+      end = start + minMinutes;
+    s_items[i] = (PackItem){start, end, i};
+  }
+  qsort(s_items, (size_t)count, sizeof(PackItem), compare_items);
+
+  int activeCount = 0, freeCount = 0;
+  int nextLane = 0;
+  int clusterFirst = 0;
+  int clusterEnd = 0;
+
+  for (int i = 0; i <= count; i++) {
+    // Close the cluster once nothing in it is still running
+    if (i == count || (i > clusterFirst && s_items[i].start >= clusterEnd)) {
+      for (int j = clusterFirst; j < i; j++)
+        out[s_items[j].pos].laneCount = (int16_t)nextLane;
+      if (i == count)
+        break;
+      clusterFirst = i;
+      activeCount = freeCount = nextLane = 0;
+    }
+
+    const PackItem *it = &s_items[i];
+    while (activeCount > 0 && s_active[0].end <= it->start)
+      lane_push(s_free, &freeCount, active_pop(s_active, &activeCount).lane);
+
+    int lane = freeCount > 0 ? lane_pop(s_free, &freeCount) : nextLane++;
+    active_push(s_active, &activeCount, (ActiveLane){it->end, lane});
+    out[it->pos].lane = (int16_t)lane;
+    if (i == clusterFirst || it->end > clusterEnd)
+      clusterEnd = it->end;
+  }
+}
@@ -0,0 +1,24 @@
+#ifndef DAY_LAYOUT_H
+#define DAY_LAYOUT_H
+
+#include "events.h"
+
+#include <stdint.h>
+
+// Side-by-side placement of one timed event within its day column
+typedef struct {
+  int16_t lane;      // 0-based lane, left to right
+  int16_t laneCount; // Lanes in the event's overlap cluster
+} EventLane;
+
+// Pack a day's timed events into lanes with a sweep line, as calendar apps
+// do for overlapping meetings: each event takes the lowest lane free at its
+// start, and every event in a cluster of transitively overlapping events
+// shares that cluster's lane count. events[] holds store indices; events
+// shorter than minMinutes are treated as minMinutes long, matching their
+// drawn height. Runs in O(n log n).
+// The week view keeps the result until its events change.
+void DayLayout_Pack(const EventStore *store, const int *events, int count,
+                    int minMinutes, EventLane *out);
+
+#endif
@@ -0,0 +1,398 @@
+#include "event_cache.h"
+#include "config_dir.h"
+#include "google_calendar.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ── File format ──────────────────────────────────────────────────────────────
+// CacheHeader, then calendarCount CacheCalendar, syncCount GoogleSyncState,
+// eventCount CacheEvent and stringBytes of NUL-terminated strings. String
+// fields are offsets into that blob; offset 0 is always "". Native byte
+// order: the file never leaves the machine.
+#define CACHE_MAGIC "FELC"
+#define CACHE_VERSION 5
+
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t calendarCount;
+  uint32_t syncCount;
+  uint32_t eventCount;
+  uint32_t stringBytes;
+  int64_t utcOffset;
+} CacheHeader;
+
+typedef struct {
+  uint32_t source;
+  char id[CAL_CALID_LEN]; // File path or Google calendar id
+  char name[CAL_NAME_LEN];
+  uint8_t color[4];
+  uint32_t visible;
+} CacheCalendar;
+
+typedef struct {
+  int64_t startTime;
+  int64_t endTime;
+  int32_t startDay;
+  int32_t endDay;
+  int16_t startMinute;
+  int16_t endMinute;
+  int32_t colorId;
+  int32_t calendarIndex;
+  int32_t window;
+  uint32_t allDay;
+  uint32_t summary, description, location, id;
+} CacheEvent;
+
+static void get_cache_path(char *buf, size_t bufsize) {
+  char dir[256];
+  get_config_dir(dir, sizeof(dir));
+  snprintf(buf, bufsize, "%s/events.cache", dir);
+}
+
+static void fill_calendars(CacheCalendar *out, const LinkedCalendar *calendars,
+                           int count) {
+  memset(out, 0, sizeof(CacheCalendar) * (size_t)count);
+  for (int i = 0; i < count; i++) {
+    const LinkedCalendar *cal = &calendars[i];
+    out[i].source = (uint32_t)cal->source;
+    // filePath and calendarId share storage
+    strncpy(out[i].id, cal->calendarId, CAL_CALID_LEN - 1);
+    strncpy(out[i].name, cal->name, CAL_NAME_LEN - 1);
+    out[i].color[0] = cal->colorR;
+    out[i].color[1] = cal->colorG;
+    out[i].color[2] = cal->colorB;
+    out[i].color[3] = cal->colorA;
+    out[i].visible = cal->visible;
+  }
+}
+
+// ── Save ─────────────────────────────────────────────────────────────────────
+typedef struct {
+  char *data;
+  size_t size, capacity;
+  bool failed;
+} Blob;
+
+static uint32_t blob_string(Blob *b, const char *s) {
+  if (!s[0])
+    return 0;
+  size_t len = strlen(s) + 1;
+  if (b->size + len > b->capacity) {
+    size_t cap = b->capacity ? b->capacity * 2 : 4096;
+    while (cap < b->size + len)
+      cap *= 2;
+    char *data = realloc(b->data, cap);
+    if (!data) {
+      b->failed = true;
+      return 0;
+    }
+    b->data = data;
+    b->capacity = cap;
+  }
+  uint32_t offset = (uint32_t)b->size;
+  memcpy(b->data + b->size, s, len);
+  b->size += len;
+  return offset;
+}
+
+bool EventCache_Save(const EventStore *store, const LinkedCalendar *calendars,
+                     int count) {
+  int maxSyncs = GoogleCalendar_SyncStateCount();
+  CacheCalendar *cals = malloc(sizeof(CacheCalendar) * (size_t)(count + 1));
+  GoogleSyncState *syncs =
+      malloc(sizeof(GoogleSyncState) * (size_t)(maxSyncs + 1));
+  CacheEvent *events = calloc((size_t)store->count + 1, sizeof(CacheEvent));
+  // Offset 0 holds the empty string
+  Blob strings = {malloc(4096), 1, 4096, false};
+  if (!cals || !syncs || !events || !strings.data) {
+    free(cals);
+    free(syncs);
+    free(events);
+    free(strings.data);
+    return false;
+  }
+  fill_calendars(cals, calendars, count);
+  int syncCount = GoogleCalendar_GetSyncStates(syncs, maxSyncs);
+  strings.data[0] = '\0';
+
+  for (int i = 0; i < store->count; i++) {
+    const CalEvent *ev = &store->items[i];
+    const CalEventDetail *d = &store->details[i];
+    events[i] = (CacheEvent){
+        .startTime = ev->startTime,
+        .endTime = ev->endTime,
+        .startDay = ev->startDay,
+        .endDay = ev->endDay,
+        .startMinute = ev->startMinute,
+        .endMinute = ev->endMinute,
+        .colorId = ev->colorId,
+        .calendarIndex = ev->calendarIndex,
+        .window = ev->window,
+        .allDay = ev->allDay,
+        .summary = blob_string(&strings, ev->summary),
+        .description = blob_string(&strings, d->description),
+        .location = blob_string(&strings, d->location),
+        .id = blob_string(&strings, d->id),
+    };
+  }
+
+  CacheHeader header = {
+      .version = CACHE_VERSION,
+      .calendarCount = (uint32_t)count,
+      .syncCount = (uint32_t)syncCount,
+      .eventCount = (uint32_t)store->count,
+      .stringBytes = (uint32_t)strings.size,
+      .utcOffset = store->utcOffset,
+  };
+  memcpy(header.magic, CACHE_MAGIC, 4);
+
+  ensure_config_dir();
+  char path[512], tmpPath[520];
+  get_cache_path(path, sizeof(path));
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+  bool ok = !strings.failed;
+  int fd = ok ? open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0600) : -1;
+  FILE *f = fd >= 0 ? fdopen(fd, "wb") : NULL;
+  if (f) {
+    ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+         fwrite(cals, sizeof(CacheCalendar), (size_t)count, f) ==
+             (size_t)count &&
+         fwrite(syncs, sizeof(GoogleSyncState), (size_t)syncCount, f) ==
+             (size_t)syncCount &&
+         fwrite(events, sizeof(CacheEvent), (size_t)store->count, f) ==
+             (size_t)store->count &&
+         fwrite(strings.data, 1, strings.size, f) == strings.size;
+    // On disk before the rename, or a crash could leave an empty file
+    // under the real name
+    ok = ok && fflush(f) == 0 && fsync(fd) == 0;
+    ok = fclose(f) == 0 && ok;
+  } else {
+    if (fd >= 0)
+      close(fd);
+    ok = false;
+  }
+  // Readers see either the old snapshot or the new one, never a torn file
+  if (ok)
+    ok = rename(tmpPath, path) == 0;
+  if (ok) {
+    // Make the rename itself durable
+    char dir[256];
+    get_config_dir(dir, sizeof(dir));
+    int dirFd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (dirFd >= 0) {
+      fsync(dirFd);
+      close(dirFd);
+    }
+  }
+  if (!ok) {
+    fprintf(stderr, "Could not write event cache %s\n", path);
+    remove(tmpPath);
+  }
+
+  free(cals);
+  free(syncs);
+  free(events);
+  free(strings.data);
+  return ok;
+}
+
+// ── Load ─────────────────────────────────────────────────────────────────────
+typedef struct {
+  CacheHeader header;
+  size_t calOffset, syncOffset, eventOffset, stringOffset;
+} CacheLayout;
+
+static bool read_layout(const uint8_t *data, size_t size, CacheLayout *out) {
+  if (size < sizeof(CacheHeader))
+    return false;
+  CacheHeader header;
+  memcpy(&header, data, sizeof(header));
+  // Every calendar has at most GCAL_STATES_PER_CALENDAR sync states
+  if (memcmp(header.magic, CACHE_MAGIC, 4) != 0 ||
+      header.version != CACHE_VERSION ||
+      (uint64_t)header.syncCount >
+          (uint64_t)header.calendarCount * GCAL_STATES_PER_CALENDAR ||
+      header.stringBytes == 0)
+    return false;
+
+  out->header = header;
+  out->calOffset = sizeof(CacheHeader);
+  out->syncOffset =
+      out->calOffset + sizeof(CacheCalendar) * (size_t)header.calendarCount;
+  out->eventOffset =
+      out->syncOffset + sizeof(GoogleSyncState) * (size_t)header.syncCount;
+  out->stringOffset =
+      out->eventOffset + sizeof(CacheEvent) * (size_t)header.eventCount;
+  return out->stringOffset + header.stringBytes == size;
+}
+
+static bool load_mapped(EventStore *store, const uint8_t *data, size_t size,
+                        const LinkedCalendar *calendars, int count,
+                        bool restoreSync) {
+  CacheLayout layout;
+  if (!read_layout(data, size, &layout) ||
+      layout.header.calendarCount != (uint32_t)count)
+    return false;
+  CacheHeader header = layout.header;
+  size_t syncOffset = layout.syncOffset;
+  size_t eventOffset = layout.eventOffset;
+  size_t stringOffset = layout.stringOffset;
+
+  // Only valid for the calendar list it was written for
+  for (int i = 0; i < count; i++) {
+    CacheCalendar cc;
+    memcpy(&cc, data + layout.calOffset + (size_t)i * sizeof(cc), sizeof(cc));
+    if (cc.source != (uint32_t)calendars[i].source ||
+        strncmp(cc.id, calendars[i].calendarId, CAL_CALID_LEN) != 0)
+      return false;
+  }
+
+  const char *strings = (const char *)data + stringOffset;
+  if (strings[header.stringBytes - 1] != '\0')
+    return false;
+
+  // One copy of the string blob; events point into it
+  EventStore_Clear(store);
+  char *blob = Arena_Push(&store->arena, header.stringBytes);
+  size_t n = header.eventCount;
+  CalEvent *items = Arena_Push(&store->arena, (n + 1) * sizeof(CalEvent));
+  CalEventDetail *details =
+      Arena_Push(&store->arena, (n + 1) * sizeof(CalEventDetail));
+  if (!blob || !items || !details) {
+    EventStore_Clear(store);
+    return false;
+  }
+  memcpy(blob, strings, header.stringBytes);
+
+  for (size_t i = 0; i < n; i++) {
+    CacheEvent ce;
+    memcpy(&ce, data + eventOffset + i * sizeof(CacheEvent), sizeof(ce));
+    if (ce.summary >= header.stringBytes ||
+        ce.description >= header.stringBytes ||
+        ce.location >= header.stringBytes || ce.id >= header.stringBytes ||
+        ce.calendarIndex < 0 || ce.calendarIndex >= count) {
+      EventStore_Clear(store);
+      return false;
+    }
+    items[i] = (CalEvent){
+        .startTime = (time_t)ce.startTime,
+        .endTime = (time_t)ce.endTime,
+        .summary = blob + ce.summary,
+        .summaryLength = (int32_t)strlen(blob + ce.summary),
+        .startDay = ce.startDay,
+        .endDay = ce.endDay,
+        .startMinute = ce.startMinute,
+        .endMinute = ce.endMinute,
+        .colorId = ce.colorId,
+        .calendarIndex = ce.calendarIndex,
+        .window = ce.window,
+        .allDay = ce.allDay != 0,
+    };
+    details[i] = (CalEventDetail){blob + ce.description, blob + ce.location,
+                                  blob + ce.id};
+  }
+  store->items = items;
+  store->details = details;
+  store->count = (int)n;
+  store->capacity = (int)n + 1;
+  // A different offset now makes the renderer relocalize
+  store->utcOffset = (long)header.utcOffset;
+  store->generation++;
+
+  if (restoreSync) {
+    GoogleCalendar_ResetSync();
+    for (uint32_t i = 0; i < header.syncCount; i++) {
+      GoogleSyncState st;
+      memcpy(&st, data + syncOffset + i * sizeof(GoogleSyncState), sizeof(st));
+      st.calendarId[CAL_CALID_LEN - 1] = '\0';
+      st.syncToken[CAL_SYNC_TOKEN_LEN - 1] = '\0';
+      st.etag[GCAL_ETAG_LEN - 1] = '\0';
+      GoogleCalendar_RestoreSyncState(&st);
+    }
+  }
+  return true;
+}
+
+bool EventCache_Load(EventStore *store, const LinkedCalendar *calendars,
+                     int count, bool restoreSync) {
+  char path[512];
+  get_cache_path(path, sizeof(path));
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+  size_t size = (size_t)st.st_size;
+  void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  bool ok = load_mapped(store, data, size, calendars, count, restoreSync);
+  munmap(data, size);
+  if (!ok)
+    fprintf(stderr, "Ignoring stale or unreadable event cache %s\n", path);
+  return ok;
+}
+
+bool EventCache_LoadCalendars(LinkedCalendar **calendars, int *count) {
+  *calendars = NULL;
+  *count = 0;
+  char path[512];
+  get_cache_path(path, sizeof(path));
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  // Only the header and calendar records are needed
+  CacheHeader header;
+  bool ok = pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+            memcmp(header.magic, CACHE_MAGIC, 4) == 0 &&
+            header.version == CACHE_VERSION;
+  size_t n = ok ? header.calendarCount : 0;
+  CacheCalendar *cals = ok ? malloc(sizeof(CacheCalendar) * (n + 1)) : NULL;
+  LinkedCalendar *list = ok ? calloc(n + 1, sizeof(LinkedCalendar)) : NULL;
+  ok = cals && list &&
+       pread(fd, cals, sizeof(CacheCalendar) * n, sizeof(CacheHeader)) ==
+           (ssize_t)(sizeof(CacheCalendar) * n);
+  close(fd);
+
+  for (size_t i = 0; ok && i < n; i++) {
+    LinkedCalendar *cal = &list[i];
+    if (cals[i].source > CAL_SOURCE_GOOGLE) {
+      ok = false;
+      break;
+    }
+    cal->source = (CalendarSource)cals[i].source;
+    memcpy(cal->calendarId, cals[i].id, CAL_CALID_LEN);
+    cal->calendarId[CAL_CALID_LEN - 1] = '\0';
+    memcpy(cal->name, cals[i].name, CAL_NAME_LEN);
+    cal->name[CAL_NAME_LEN - 1] = '\0';
+    cal->colorR = cals[i].color[0];
+    cal->colorG = cals[i].color[1];
+    cal->colorB = cals[i].color[2];
+    cal->colorA = cals[i].color[3];
+    cal->visible = cals[i].visible != 0;
+  }
+  free(cals);
+  if (!ok) {
+    free(list);
+    return false;
+  }
+  *calendars = list;
+  *count = (int)n;
+  return true;
+}
@@ -0,0 +1,28 @@
+#ifndef EVENT_CACHE_H
+#define EVENT_CACHE_H
+
+#include "events.h"
+
+#include <stdbool.h>
+
+// Binary snapshot of the synced events and Google sync tokens (with the
+// ETags that revalidate them), kept in the config dir next to tokens.json.
+// Loading it maps the file and copies the records straight into a store, so
+// the week view has events on the first frame and stays usable offline.
+//
+// The snapshot is tied to the calendar list it was written for, which it
+// stores too; a different list (or a different format version) makes it
+// count as missing.
+
+// Write store and the current sync tokens (temp file, fsync, rename)
+bool EventCache_Save(const EventStore *store, const LinkedCalendar *calendars,
+                     int count);
+// Replace store with the snapshot. With restoreSync, the saved sync tokens
+// are handed back to the Google sync code as well.
+bool EventCache_Load(EventStore *store, const LinkedCalendar *calendars,
+                     int count, bool restoreSync);
+// Just the calendar list (names, colors and visibility included) the
+// snapshot was written for. *calendars is malloc'd; the caller frees it.
+bool EventCache_LoadCalendars(LinkedCalendar **calendars, int *count);
+
+#endif
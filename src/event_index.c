@@ -0,0 +1,141 @@
+#include "event_index.h"
+
+#include <stdlib.h>
+
+// Layout follows the implicit interval tree from Heng Li's cgranges: in a
+// sorted array, node i sits at level k where k is the number of trailing 1
+// bits of i; its children are i -/+ 2^(k-1).
+
+void EventIndex_Clear(EventIndex *idx) {
+  idx->count = 0;
+  idx->maxLevel = -1;
+}
+
+bool EventIndex_Add(EventIndex *idx, int lo, int hi, int id) {
+  if (idx->count == idx->capacity) {
+    int newCap = idx->capacity ? idx->capacity * 2 : 256;
+    EventIndexNode *nodes =
+        realloc(idx->nodes, (size_t)newCap * sizeof(EventIndexNode));
+    if (!nodes)
+      return false;
+    idx->nodes = nodes;
+    idx->capacity = newCap;
+  }
+  idx->nodes[idx->count++] = (EventIndexNode){lo, hi, hi, id};
+  return true;
+}
+
+static int compare_nodes(const void *pa, const void *pb) {
+  const EventIndexNode *a = pa, *b = pb;
+  if (a->lo != b->lo)
+    return a->lo < b->lo ? -1 : 1;
+  return (a->id > b->id) - (a->id < b->id);
+}
+
+void EventIndex_Build(EventIndex *idx) {
+  EventIndexNode *a = idx->nodes;
+  int n = idx->count;
+  idx->maxLevel = -1;
+  if (n == 0)
+    return;
+
+  qsort(a, (size_t)n, sizeof(EventIndexNode), compare_nodes);
+
+  // Leaves (even indices) just carry their own hi. `last` tracks the max of
+  // the rightmost existing subtree, standing in for missing right children.
+  int lastI = 0, last = 0;
+  for (int i = 0; i < n; i += 2) {
+    lastI = i;
+    last = a[i].maxHi = a[i].hi;
+  }
+  int k;
+  for (k = 1; (1 << k) <= n; k++) {
+    int x = 1 << (k - 1);
+    int i0 = (x << 1) - 1;
+    int step = x << 2;
+    for (int i = i0; i < n; i += step) {
+      int el = a[i - x].maxHi;
+      int er = i + x < n ? a[i + x].maxHi : last;
+      int e = a[i].hi;
+      if (el > e)
+        e = el;
+      if (er > e)
+        e = er;
+      a[i].maxHi = e;
+    }
+    lastI = (lastI >> k & 1) ? lastI - x : lastI + x;
+    if (lastI < n && a[lastI].maxHi > last)
+      last = a[lastI].maxHi;
+  }
+  idx->maxLevel = k - 1;
+}
+
+static void result_push(EventIndexResult *out, int id) {
+  if (out->count == out->capacity) {
+    int newCap = out->capacity ? out->capacity * 2 : 64;
+    int *items = realloc(out->items, (size_t)newCap * sizeof(int));
+    if (!items)
+      return;
+    out->items = items;
+    out->capacity = newCap;
+  }
+  out->items[out->count++] = id;
+}
+
+void EventIndex_Query(const EventIndex *idx, int lo, int hi,
+                      EventIndexResult *out) {
+  const EventIndexNode *a = idx->nodes;
+  int n = idx->count;
+  if (idx->maxLevel < 0)
+    return;
+
+  // Explicit stack of (node, level, leftDone); depth is bounded by the tree
+  // height, so 64 entries cover any int-sized array.
+  struct {
+    int x, k, leftDone;
+  } stack[64];
+  int top = 0;
+  stack[top].x = (1 << idx->maxLevel) - 1;
+  stack[top].k = idx->maxLevel;
+  stack[top++].leftDone = 0;
+
+  while (top > 0) {
+    int x = stack[--top].x, k = stack[top].k, leftDone = stack[top].leftDone;
+    if (k <= 3) {
+      // Small subtree: a linear scan beats walking it
+      int i0 = x >> k << k;
+      int i1 = i0 + (1 << (k + 1)) - 1;
+      if (i1 > n)
+        i1 = n;
+      for (int i = i0; i < i1 && a[i].lo < hi; i++) {
+        if (lo < a[i].hi)
+          result_push(out, a[i].id);
+      }
+    } else if (!leftDone) {
+      int y = x - (1 << (k - 1));
+      stack[top].x = x;
+      stack[top].k = k;
+      stack[top++].leftDone = 1;
+      // Nodes past the end are virtual; their subtree may still hold data
+      if (y >= n || a[y].maxHi > lo) {
+        stack[top].x = y;
+        stack[top].k = k - 1;
+        stack[top++].leftDone = 0;
+      }
+    } else if (x < n && a[x].lo < hi) {
+      if (lo < a[x].hi)
+        result_push(out, a[x].id);
+      stack[top].x = x + (1 << (k - 1));
+      stack[top].k = k - 1;
+      stack[top++].leftDone = 0;
+    }
+  }
+}
+
+void EventIndex_Free(EventIndex *idx) {
+  free(idx->nodes);
+  idx->nodes = NULL;
+  idx->count = 0;
+  idx->capacity = 0;
+  idx->maxLevel = -1;
+}
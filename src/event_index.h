@@ -0,0 +1,40 @@
+#ifndef EVENT_INDEX_H
+#define EVENT_INDEX_H
+
+#include <stdbool.h>
+
+// Static interval index over half-open integer ranges [lo, hi). Intervals
+// are kept in an array sorted by lo that doubles as an implicit balanced
+// binary tree; each node also stores the max hi of its subtree, so an
+// overlap query visits O(log n + k) nodes.
+typedef struct {
+  int lo, hi;
+  int maxHi; // Max hi over this node's implicit subtree
+  int id;
+} EventIndexNode;
+
+typedef struct {
+  EventIndexNode *nodes;
+  int count;
+  int capacity;
+  int maxLevel;
+} EventIndex;
+
+// Growable list of ids returned by EventIndex_Query
+typedef struct {
+  int *items;
+  int count;
+  int capacity;
+} EventIndexResult;
+
+void EventIndex_Clear(EventIndex *idx);
+bool EventIndex_Add(EventIndex *idx, int lo, int hi, int id);
+// Sort and augment; call after the last Add and before querying
+void EventIndex_Build(EventIndex *idx);
+// Appends the ids of all intervals overlapping [lo, hi) to out, ordered by
+// (lo, id)
+void EventIndex_Query(const EventIndex *idx, int lo, int hi,
+                      EventIndexResult *out);
+void EventIndex_Free(EventIndex *idx);
+
+#endif
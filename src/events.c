@@ -1,76 +1,132 @@
 #include "events.h"
+#include "datetime.h"
+#include "event_cache.h"
 #include "google_auth.h"
 #include "google_calendar.h"
-#include "cJSON.h"
+#include "json_reader.h"
+#include "refresh_scheduler.h"
+#include "sync_worker.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <time.h>
 
-CalEvent g_events[CAL_MAX_EVENTS];
-int g_eventCount = 0;
+// Front and back buffers; see sync_worker.h
+static EventStore s_stores[2];
+EventStore *g_eventStore = &s_stores[0];
 bool g_eventsLoaded = false;
 
-LinkedCalendar g_calendars[CAL_MAX_CALENDARS];
+LinkedCalendar *g_calendars = NULL;
 int g_calendarCount = 0;
+static int s_calendarCapacity = 0;
 
-// Parse "2026-02-27T09:00:00-05:00" -> time_t UTC
-// or    "2026-02-27T09:00:00Z"      -> time_t UTC
-static time_t parse_datetime(const char *s) {
-  struct tm t = {0};
-  int tzOffsetMinutes = 0;
-  // "YYYY-MM-DDTHH:MM:SS"
-  sscanf(s, "%d-%d-%dT%d:%d:%d", &t.tm_year, &t.tm_mon, &t.tm_mday, &t.tm_hour,
-         &t.tm_min, &t.tm_sec);
-  t.tm_year -= 1900;
-  t.tm_mon -= 1;
-  t.tm_isdst = -1;
-
-  // Find timezone part after the seconds
-  const char *tz = s + 19; // past "YYYY-MM-DDTHH:MM:SS"
-  if (*tz == '.') {
-    while (*tz && *tz != '+' && *tz != '-' && *tz != 'Z')
-      tz++;
-  }
-  if (*tz == 'Z') {
-    tzOffsetMinutes = 0;
-  } else if (*tz == '+' || *tz == '-') {
-    int sign = (*tz == '+') ? 1 : -1;
-    int tzh = 0, tzm = 0;
-    sscanf(tz + 1, "%d:%d", &tzh, &tzm);
-    tzOffsetMinutes = sign * (tzh * 60 + tzm);
-  }
-
-  // timegm equivalent: interpret t as UTC then subtract tz offset
-  // Set TZ to UTC temporarily.
-  char *old_tz = getenv("TZ");
-  char saved_tz[256] = "";
-  if (old_tz)
-    strncpy(saved_tz, old_tz, sizeof(saved_tz) - 1);
-  setenv("TZ", "UTC", 1);
-  tzset();
-  time_t utc = mktime(&t);
-  if (old_tz)
-    setenv("TZ", saved_tz, 1);
-  else
-    unsetenv("TZ");
-  tzset();
-
-  // Subtract tz offset (offset means "local = UTC + offset")
-  utc -= tzOffsetMinutes * 60;
-  return utc;
-}
-
-// Parse "2026-02-28" -> year/mon/mday (1-indexed month)
-static void parse_date(const char *s, int *year, int *mon, int *mday) {
-  sscanf(s, "%d-%d-%d", year, mon, mday);
+#define EVENT_STORE_MIN_CAPACITY 256
+
+int EventStore_Append(EventStore *store) {
+  if (store->count == store->capacity) {
+    int newCap =
+        store->capacity ? store->capacity * 2 : EVENT_STORE_MIN_CAPACITY;
+    CalEvent *items =
+        Arena_Push(&store->arena, (size_t)newCap * sizeof(CalEvent));
+    CalEventDetail *details =
+        Arena_Push(&store->arena, (size_t)newCap * sizeof(CalEventDetail));
+    if (!items || !details)
+      return -1;
+    if (store->count > 0) {
+      memcpy(items, store->items, (size_t)store->count * sizeof(CalEvent));
+      memcpy(details, store->details,
+             (size_t)store->count * sizeof(CalEventDetail));
+    }
+    store->items = items;
+    store->details = details;
+    store->capacity = newCap;
+  }
+  int index = store->count++;
+  store->generation++;
+  memset(&store->items[index], 0, sizeof(CalEvent));
+  store->items[index].summary = "";
+  store->details[index] = (CalEventDetail){"", "", ""};
+  return index;
+}
+
+void EventStore_Clear(EventStore *store) {
+  Arena_Release(&store->arena);
+  EventIndex_Free(&store->index);
+  store->generation++;
+  store->items = NULL;
+  store->details = NULL;
+  store->count = 0;
+  store->capacity = 0;
+}
+
+const CalEventDetail *EventStore_GetDetail(const EventStore *store,
+                                           int index) {
+  static const CalEventDetail empty = {"", "", ""};
+  if (index < 0 || index >= store->count)
+    return &empty;
+  return &store->details[index];
 }
 
+static bool reserve_calendars(int count) {
+  if (count <= s_calendarCapacity)
+    return true;
+  int cap = s_calendarCapacity ? s_calendarCapacity : 16;
+  while (cap < count)
+    cap *= 2;
+  LinkedCalendar *calendars =
+      realloc(g_calendars, sizeof(LinkedCalendar) * (size_t)cap);
+  if (!calendars)
+    return false;
+  g_calendars = calendars;
+  s_calendarCapacity = cap;
+  return true;
+}
+
+static bool same_calendar(const LinkedCalendar *a, const LinkedCalendar *b) {
+  // filePath and calendarId share storage, so one compare covers both
+  return a->source == b->source && strcmp(a->calendarId, b->calendarId) == 0;
+}
+
+static const LinkedCalendar *find_calendar(const LinkedCalendar *calendars,
+                                           int count,
+                                           const LinkedCalendar *cal) {
+  for (int i = 0; i < count; i++) {
+    if (same_calendar(&calendars[i], cal))
+      return &calendars[i];
+  }
+  return NULL;
+}
+
+// Until the next discovery finds the rest, only the primary calendar is
+// linked; the sync worker replaces this list with the full one. Signed out,
+// the Google calendars go. File calendars and visibility are kept.
 void Calendar_InitCalendars(void) {
-  g_calendarCount = 0;
+  bool signedIn = GoogleAuth_GetState() == AUTH_AUTHENTICATED;
+  int *newIndex = malloc(sizeof(int) * (size_t)(g_calendarCount + 1));
+  int kept = 0;
+  bool linked = false;
+  for (int i = 0; i < g_calendarCount; i++) {
+    bool keep = signedIn || g_calendars[i].source != CAL_SOURCE_GOOGLE;
+    if (newIndex)
+      newIndex[i] = keep ? kept : -1;
+    if (!keep)
+      continue;
+    linked |= g_calendars[i].source == CAL_SOURCE_GOOGLE;
+    g_calendars[kept++] = g_calendars[i];
+  }
+  // The store on screen stays in step, so its events don't show under the
+  // calendars that moved into the dropped ones' places
+  if (newIndex && kept != g_calendarCount)
+    EventStore_RemapCalendars(g_eventStore, newIndex, g_calendarCount);
+  free(newIndex);
+  g_calendarCount = kept;
 
-  if (g_authState == AUTH_AUTHENTICATED) {
+  // Appended so no index moves; discovery puts it first
+  if (signedIn && !linked && reserve_calendars(g_calendarCount + 1)) {
     LinkedCalendar *gcal = &g_calendars[g_calendarCount++];
+    memset(gcal, 0, sizeof(*gcal));
     strncpy(gcal->name, "Google", CAL_NAME_LEN - 1);
     gcal->source = CAL_SOURCE_GOOGLE;
     strncpy(gcal->calendarId, "primary", CAL_CALID_LEN - 1);
@@ -79,85 +135,690 @@ void Calendar_InitCalendars(void) {
   }
 }
 
-void load_events_from_json(const char *json, int calIndex) {
-  cJSON *root = cJSON_Parse(json);
-  if (!root)
+void Calendar_SetCalendars(const LinkedCalendar *calendars, int count) {
+  LinkedCalendar *merged = malloc(sizeof(LinkedCalendar) * (size_t)(count + 1));
+  if (!merged || !reserve_calendars(count)) {
+    free(merged);
     return;
+  }
+  for (int i = 0; i < count; i++) {
+    merged[i] = calendars[i];
+    const LinkedCalendar *old =
+        find_calendar(g_calendars, g_calendarCount, &calendars[i]);
+    if (old)
+      merged[i].visible = old->visible;
+  }
+  memcpy(g_calendars, merged, sizeof(LinkedCalendar) * (size_t)count);
+  g_calendarCount = count;
+  free(merged);
+}
 
-  const cJSON *items = cJSON_GetObjectItemCaseSensitive(root, "items");
-  if (!cJSON_IsArray(items)) {
-    cJSON_Delete(root);
-    return;
+LinkedCalendar *Calendar_DiscoverCalendars(const LinkedCalendar *base,
+                                           int baseCount, int *count) {
+  bool linked = false;
+  for (int i = 0; i < baseCount; i++)
+    linked |= base[i].source == CAL_SOURCE_GOOGLE;
+  LinkedCalendar *google = NULL;
+  int googleCount = 0;
+  if (linked && !GoogleCalendar_ListCalendars(&google, &googleCount))
+    return NULL;
+
+  LinkedCalendar *list =
+      malloc(sizeof(LinkedCalendar) * (size_t)(googleCount + baseCount + 1));
+  if (!list) {
+    free(google);
+    return NULL;
+  }
+  int n = 0;
+  for (int i = 0; i < googleCount; i++) {
+    list[n] = google[i];
+    const LinkedCalendar *old = find_calendar(base, baseCount, &google[i]);
+    if (old)
+      list[n].visible = old->visible;
+    n++;
   }
+  for (int i = 0; i < baseCount; i++) {
+    if (base[i].source == CAL_SOURCE_FILE)
+      list[n++] = base[i];
+  }
+  free(google);
+  *count = n;
+  return list;
+}
 
-  const cJSON *item = NULL;
-  cJSON_ArrayForEach(item, items) {
-    if (g_eventCount >= CAL_MAX_EVENTS)
-      break;
+static void local_day_minute(time_t t, int *day, int16_t *minute) {
+  struct tm lt;
+  localtime_r(&t, &lt);
+  *day = (int)DateTime_DaysFromCivil(lt.tm_year + 1900, lt.tm_mon + 1,
+                                     lt.tm_mday);
+  *minute = (int16_t)(lt.tm_hour * 60 + lt.tm_min);
+}
+
+static void localize_event(CalEvent *ev) {
+  if (ev->allDay)
+    return;
+  local_day_minute(ev->startTime, &ev->startDay, &ev->startMinute);
+  local_day_minute(ev->endTime, &ev->endDay, &ev->endMinute);
+}
+
+void EventStore_Localize(EventStore *store, int first) {
+  time_t now = time(NULL);
+  struct tm lt;
+  localtime_r(&now, &lt);
+  // Events kept across syncs were localized in the old offset
+  if (lt.tm_gmtoff != store->utcOffset)
+    first = 0;
+  store->utcOffset = lt.tm_gmtoff;
 
-    CalEvent ev = {0};
-    ev.calendarIndex = calIndex;
+  if (first >= store->count)
+    return;
+  for (int i = first; i < store->count; i++)
+    localize_event(&store->items[i]);
+  store->generation++;
+}
 
-    const cJSON *summary = cJSON_GetObjectItemCaseSensitive(item, "summary");
-    if (cJSON_IsString(summary) && summary->valuestring) {
-      strncpy(ev.summary, summary->valuestring, CAL_SUMMARY_LEN - 1);
+// Remove events matching calIndex (unless anyCalendar) and window (unless
+// anyWindow). Every int is a valid key here, hence flags not wildcards.
+static void remove_events(EventStore *store, bool anyCalendar, int calIndex,
+                          bool anyWindow, int window) {
+  int kept = 0;
+  for (int i = 0; i < store->count; i++) {
+    const CalEvent *ev = &store->items[i];
+    if ((anyCalendar || ev->calendarIndex == calIndex) &&
+        (anyWindow || ev->window == window))
+      continue;
+    if (kept != i) {
+      store->items[kept] = store->items[i];
+      store->details[kept] = store->details[i];
     }
+    kept++;
+  }
+  // Caches (and the sync worker's publish check) only see real changes
+  if (kept == store->count)
+    return;
+  store->count = kept;
+  store->generation++;
+}
 
-    const cJSON *desc = cJSON_GetObjectItemCaseSensitive(item, "description");
-    if (cJSON_IsString(desc) && desc->valuestring) {
-      strncpy(ev.description, desc->valuestring, CAL_DESC_LEN - 1);
+void EventStore_RemapCalendars(EventStore *store, const int *newIndex,
+                               int count) {
+  bool moved = false;
+  for (int i = 0; i < store->count; i++) {
+    CalEvent *ev = &store->items[i];
+    int to = ev->calendarIndex >= 0 && ev->calendarIndex < count
+                 ? newIndex[ev->calendarIndex]
+                 : -1;
+    if (to != ev->calendarIndex) {
+      ev->calendarIndex = to;
+      moved = true;
     }
+  }
+  if (moved)
+    store->generation++;
+  EventStore_RemoveCalendar(store, -1);
+}
 
-    const cJSON *loc = cJSON_GetObjectItemCaseSensitive(item, "location");
-    if (cJSON_IsString(loc) && loc->valuestring) {
-      strncpy(ev.location, loc->valuestring, CAL_LOC_LEN - 1);
+void EventStore_RemoveCalendar(EventStore *store, int calIndex) {
+  remove_events(store, false, calIndex, true, 0);
+}
+
+void EventStore_RemoveCalendarWindow(EventStore *store, int calIndex,
+                                     int window) {
+  remove_events(store, false, calIndex, false, window);
+}
+
+void EventStore_RemoveWindow(EventStore *store, int window) {
+  remove_events(store, true, 0, false, window);
+}
+
+static const char *copy_string(Arena *arena, const char *s) {
+  if (!s[0])
+    return "";
+  const char *copy = Arena_PushString(arena, s, strlen(s));
+  return copy ? copy : "";
+}
+
+// copy_string for a string of known length; the length drops to 0 along
+// with the copy if the arena is out of memory
+static const char *copy_text(Arena *arena, const char *s, int32_t *length) {
+  const char *copy =
+      *length ? Arena_PushString(arena, s, (size_t)*length) : NULL;
+  if (!copy)
+    *length = 0;
+  return copy ? copy : "";
+}
+
+bool EventStore_CopyFrom(EventStore *dst, const EventStore *src) {
+  EventStore_Clear(dst);
+  dst->utcOffset = src->utcOffset;
+  if (src->count == 0)
+    return true;
+
+  size_t n = (size_t)src->count;
+  dst->items = Arena_Push(&dst->arena, n * sizeof(CalEvent));
+  dst->details = Arena_Push(&dst->arena, n * sizeof(CalEventDetail));
+  if (!dst->items || !dst->details) {
+    EventStore_Clear(dst);
+    return false;
+  }
+  memcpy(dst->items, src->items, n * sizeof(CalEvent));
+  for (size_t i = 0; i < n; i++) {
+    const CalEventDetail *d = &src->details[i];
+    dst->items[i].summary = copy_text(&dst->arena, src->items[i].summary,
+                                      &dst->items[i].summaryLength);
+    dst->details[i] = (CalEventDetail){
+        copy_string(&dst->arena, d->description),
+        copy_string(&dst->arena, d->location),
+        copy_string(&dst->arena, d->id),
+    };
+  }
+  dst->count = src->count;
+  dst->capacity = src->count;
+  dst->generation++;
+  return true;
+}
+
+void EventStore_QueryDays(EventStore *store, int firstDay, int endDay,
+                          EventIndexResult *out) {
+  if (store->indexGeneration != store->generation) {
+    EventIndex_Clear(&store->index);
+    for (int i = 0; i < store->count; i++) {
+      const CalEvent *ev = &store->items[i];
+      int hi = ev->allDay ? ev->endDay : ev->startDay + 1;
+      if (!EventIndex_Add(&store->index, ev->startDay, hi, i)) {
+        fprintf(stderr, "Out of memory while indexing events\n");
+        break;
+      }
+    }
+    EventIndex_Build(&store->index);
+    store->indexGeneration = store->generation;
+  }
+  EventIndex_Query(&store->index, firstDay, endDay, out);
+}
+
+// Decode a string token into the store's arena ("" if not a string). The
+// decoded length goes to *length unless it is NULL.
+static const char *store_string(EventStore *store, const JsonToken *tok,
+                                size_t *length) {
+  if (length)
+    *length = 0;
+  if (tok->type != JSON_TOK_STRING)
+    return "";
+  char *copy = Arena_Push(&store->arena, tok->length + 1);
+  if (!copy)
+    return "";
+  size_t n = JsonToken_DecodeString(tok, copy);
+  if (length)
+    *length = n;
+  return copy;
+}
+
+// Copy a short scalar token into a NUL-terminated stack buffer
+static void token_to_buf(const JsonToken *tok, char *buf, size_t bufsize) {
+  size_t n = tok->length < bufsize - 1 ? tok->length : bufsize - 1;
+  memcpy(buf, tok->start, n);
+  buf[n] = '\0';
+}
+
+// ── Extracted fields ─────────────────────────────────────────────────────────
+// Every key the parser reads. The parse loops dispatch on these tables and
+// events_fields_mask builds the request's fields= mask from them, so a key
+// can't be parsed without being requested or requested without being parsed.
+typedef struct FieldSpec {
+  const char *name;
+  const struct FieldSpec *fields; // Subfields of an object value, or NULL
+  int fieldCount;
+} FieldSpec;
+
+typedef enum {
+  TIME_DATE,
+  TIME_DATE_TIME,
+  TIME_FIELD_COUNT,
+} TimeField;
+
+static const FieldSpec k_timeFields[TIME_FIELD_COUNT] = {
+    [TIME_DATE] = {"date", NULL, 0},
+    [TIME_DATE_TIME] = {"dateTime", NULL, 0},
+};
+
+typedef enum {
+  EVENT_ID,
+  EVENT_STATUS,
+  EVENT_SUMMARY,
+  EVENT_DESCRIPTION,
+  EVENT_LOCATION,
+  EVENT_COLOR_ID,
+  EVENT_START,
+  EVENT_END,
+  EVENT_FIELD_COUNT,
+} EventField;
+
+static const FieldSpec k_eventFields[EVENT_FIELD_COUNT] = {
+    [EVENT_ID] = {"id", NULL, 0},
+    [EVENT_STATUS] = {"status", NULL, 0},
+    [EVENT_SUMMARY] = {"summary", NULL, 0},
+    [EVENT_DESCRIPTION] = {"description", NULL, 0},
+    [EVENT_LOCATION] = {"location", NULL, 0},
+    [EVENT_COLOR_ID] = {"colorId", NULL, 0},
+    [EVENT_START] = {"start", k_timeFields, TIME_FIELD_COUNT},
+    [EVENT_END] = {"end", k_timeFields, TIME_FIELD_COUNT},
+};
+
+typedef enum {
+  RESPONSE_NEXT_PAGE_TOKEN,
+  RESPONSE_NEXT_SYNC_TOKEN,
+  RESPONSE_ITEMS,
+  RESPONSE_FIELD_COUNT,
+} ResponseField;
+
+static const FieldSpec k_responseFields[RESPONSE_FIELD_COUNT] = {
+    [RESPONSE_NEXT_PAGE_TOKEN] = {"nextPageToken", NULL, 0},
+    [RESPONSE_NEXT_SYNC_TOKEN] = {"nextSyncToken", NULL, 0},
+    [RESPONSE_ITEMS] = {"items", k_eventFields, EVENT_FIELD_COUNT},
+};
+
+// Index of key in fields, or count if it isn't one of them
+static int field_lookup(const JsonToken *key, const FieldSpec *fields,
+                        int count) {
+  int i = 0;
+  while (i < count && !JsonToken_Equals(key, fields[i].name))
+    i++;
+  return i;
+}
+
+// Append to out, tracking the length the whole mask would need
+static void mask_append(char *out, size_t size, size_t *len, const char *s) {
+  size_t n = strlen(s);
+  if (*len + n < size)
+    memcpy(out + *len, s, n + 1);
+  *len += n;
+}
+
+static void mask_fields(char *out, size_t size, size_t *len,
+                        const FieldSpec *fields, int count) {
+  for (int i = 0; i < count; i++) {
+    if (i > 0)
+      mask_append(out, size, len, ",");
+    mask_append(out, size, len, fields[i].name);
+    if (fields[i].fields) {
+      mask_append(out, size, len, "(");
+      mask_fields(out, size, len, fields[i].fields, fields[i].fieldCount);
+      mask_append(out, size, len, ")");
     }
+  }
+}
+
+size_t events_fields_mask(char *out, size_t size) {
+  size_t len = 0;
+  if (size > 0)
+    out[0] = '\0';
+  mask_fields(out, size, &len, k_responseFields, RESPONSE_FIELD_COUNT);
+  return len;
+}
 
-    const cJSON *colorId = cJSON_GetObjectItemCaseSensitive(item, "colorId");
-    if (cJSON_IsString(colorId) && colorId->valuestring) {
-      ev.colorId = atoi(colorId->valuestring);
-    } else if (cJSON_IsNumber(colorId)) {
-      ev.colorId = colorId->valueint;
+// Parse a "start"/"end" object: {"dateTime": ...} or {"date": ...}
+static bool parse_event_time(JsonReader *r, CalEvent *ev, bool isStart) {
+  JsonToken key, val;
+  char buf[64];
+  while (JsonReader_Next(r, &key) == JSON_TOK_STRING) {
+    if (JsonReader_Next(r, &val) == JSON_TOK_ERROR)
+      return false;
+    TimeField field =
+        (TimeField)field_lookup(&key, k_timeFields, TIME_FIELD_COUNT);
+    if (val.type == JSON_TOK_STRING && field == TIME_DATE_TIME) {
+      token_to_buf(&val, buf, sizeof(buf));
+      if (isStart) {
+        DateTime_ParseRFC3339(buf, &ev->startTime);
+        ev->allDay = false;
+      } else if (!ev->allDay) {
+        DateTime_ParseRFC3339(buf, &ev->endTime);
+      }
+    } else if (val.type == JSON_TOK_STRING && field == TIME_DATE) {
+      token_to_buf(&val, buf, sizeof(buf));
+      int y, m, d;
+      if (!DateTime_ParseDate(buf, &y, &m, &d))
+        continue;
+      if (isStart) {
+        ev->startDay = (int)DateTime_DaysFromCivil(y, m, d);
+        ev->allDay = true;
+      } else if (ev->allDay) {
+        ev->endDay = (int)DateTime_DaysFromCivil(y, m, d);
+      }
+    } else if (!JsonReader_SkipValue(r, &val)) {
+      return false;
     }
+  }
+  return key.type == JSON_TOK_OBJECT_END;
+}
+
+// Parse one element of "items" straight into the event store. Only the
+// fields the app uses are decoded; every other subtree is skipped in place.
+static bool parse_event(JsonReader *r, EventStore *store, int calIndex,
+                        int window, bool *cancelled) {
+  int index = EventStore_Append(store);
+  if (index < 0) {
+    fprintf(stderr, "Out of memory while loading events\n");
+    return false;
+  }
+  CalEvent ev = store->items[index];
+  CalEventDetail *detail = &store->details[index];
+  ev.calendarIndex = calIndex;
+  ev.window = window;
 
-    const cJSON *start = cJSON_GetObjectItemCaseSensitive(item, "start");
-    if (cJSON_IsObject(start)) {
-      const cJSON *dt = cJSON_GetObjectItemCaseSensitive(start, "dateTime");
-      if (cJSON_IsString(dt) && dt->valuestring) {
-        ev.startTime = parse_datetime(dt->valuestring);
-        ev.allDay = false;
+  // "start" precedes "end" in Google's responses, but don't rely on it:
+  // the end object is parsed once we know whether the event is all-day.
+  JsonReader endReader = {0};
+  JsonToken endTok = {0};
+
+  JsonToken key, val;
+  while (JsonReader_Next(r, &key) == JSON_TOK_STRING) {
+    if (JsonReader_Next(r, &val) == JSON_TOK_ERROR)
+      return false;
+
+    bool ok = true;
+    switch ((EventField)field_lookup(&key, k_eventFields, EVENT_FIELD_COUNT)) {
+    case EVENT_SUMMARY: {
+      size_t length;
+      ev.summary = store_string(store, &val, &length);
+      ev.summaryLength = (int32_t)length;
+      break;
+    }
+    case EVENT_DESCRIPTION:
+      detail->description = store_string(store, &val, NULL);
+      break;
+    case EVENT_LOCATION:
+      detail->location = store_string(store, &val, NULL);
+      break;
+    case EVENT_ID:
+      detail->id = store_string(store, &val, NULL);
+      break;
+    case EVENT_STATUS:
+      *cancelled = val.type == JSON_TOK_STRING &&
+                   JsonToken_Equals(&val, "cancelled");
+      break;
+    case EVENT_COLOR_ID:
+      if (val.type == JSON_TOK_STRING || val.type == JSON_TOK_NUMBER) {
+        char buf[16];
+        token_to_buf(&val, buf, sizeof(buf));
+        ev.colorId = atoi(buf);
       } else {
-        const cJSON *d = cJSON_GetObjectItemCaseSensitive(start, "date");
-        if (cJSON_IsString(d) && d->valuestring) {
-          parse_date(d->valuestring, &ev.startYear, &ev.startMon,
-                     &ev.startMday);
-          ev.allDay = true;
-        }
+        ok = JsonReader_SkipValue(r, &val);
       }
+      break;
+    case EVENT_START:
+      ok = val.type == JSON_TOK_OBJECT_BEGIN ? parse_event_time(r, &ev, true)
+                                             : JsonReader_SkipValue(r, &val);
+      break;
+    case EVENT_END:
+      if (val.type == JSON_TOK_OBJECT_BEGIN) {
+        endReader = *r;
+        endTok = val;
+      }
+      ok = JsonReader_SkipValue(r, &val);
+      break;
+    default:
+      ok = JsonReader_SkipValue(r, &val);
+      break;
     }
+    if (!ok)
+      return false;
+  }
+  if (key.type != JSON_TOK_OBJECT_END)
+    return false;
 
-    const cJSON *end = cJSON_GetObjectItemCaseSensitive(item, "end");
-    if (cJSON_IsObject(end)) {
-      if (!ev.allDay) {
-        const cJSON *dt = cJSON_GetObjectItemCaseSensitive(end, "dateTime");
-        if (cJSON_IsString(dt) && dt->valuestring) {
-          ev.endTime = parse_datetime(dt->valuestring);
+  if (endTok.type == JSON_TOK_OBJECT_BEGIN &&
+      !parse_event_time(&endReader, &ev, false))
+    return false;
+
+  store->items[index] = ev;
+  return true;
+}
+
+// ── Incremental merge ───────────────────────────────────────────────────────
+// Open-addressing map from event id to store index over one calendar
+// window's events, built on the first item of a delta that needs it
+typedef struct {
+  int *slots; // index + 1, 0 = empty
+  uint32_t mask;
+} IdMap;
+
+static uint32_t hash_id(const char *s) {
+  uint32_t h = 2166136261u;
+  while (*s) {
+    h ^= (uint8_t)*s++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static bool idmap_build(IdMap *m, const EventStore *store, int count,
+                        int calIndex, int window) {
+  uint32_t size = 16;
+  while (size < (uint32_t)count * 2)
+    size *= 2;
+  m->slots = calloc(size, sizeof(int));
+  if (!m->slots)
+    return false;
+  m->mask = size - 1;
+  for (int i = 0; i < count; i++) {
+    const char *id = store->details[i].id;
+    if (store->items[i].calendarIndex != calIndex ||
+        store->items[i].window != window || !id[0])
+      continue;
+    uint32_t h = hash_id(id) & m->mask;
+    while (m->slots[h])
+      h = (h + 1) & m->mask;
+    m->slots[h] = i + 1;
+  }
+  return true;
+}
+
+static int idmap_find(const IdMap *m, const EventStore *store, const char *id) {
+  uint32_t h = hash_id(id) & m->mask;
+  while (m->slots[h]) {
+    int index = m->slots[h] - 1;
+    if (strcmp(store->details[index].id, id) == 0)
+      return index;
+    h = (h + 1) & m->mask;
+  }
+  return -1;
+}
+
+// Whether an event falls in the week window starting on day `window`, as a
+// timeMin/timeMax request for that week would have returned it
+static bool in_window(const CalEvent *ev, int window) {
+  if (ev->allDay)
+    return ev->startDay < window + 7 && ev->endDay > window;
+  return ev->startDay < window + 7 &&
+         (ev->endDay > window || (ev->endDay == window && ev->endMinute > 0));
+}
+
+// Fold the event just appended at the end of the store into the events that
+// were there before the response (indices below baseCount). Returns true if
+// it deleted one of them.
+//
+// A delta lists changes anywhere in the calendar, not just in the window
+// being synced. Items outside the window are handled like cancellations:
+// they drop the window's copy (the event moved away) and aren't added. The
+// delta of the window they moved to picks them up.
+static bool merge_item(EventStore *store, IdMap *ids, int baseCount,
+                       int calIndex, int window, bool delta, bool cancelled) {
+  int index = store->count - 1;
+  int existing = -1;
+  const char *id = store->details[index].id;
+  if (delta && window != CAL_WINDOW_ALL && !cancelled) {
+    localize_event(&store->items[index]);
+    cancelled = !in_window(&store->items[index], window);
+  }
+  if (delta && id[0]) {
+    if (!ids->slots &&
+        !idmap_build(ids, store, baseCount, calIndex, window))
+      fprintf(stderr, "Out of memory while merging events\n");
+    if (ids->slots)
+      existing = idmap_find(ids, store, id);
+  }
+
+  bool removed = false;
+  if (existing >= 0) {
+    if (cancelled) {
+      // Parked on calendar -1 and compacted away once the response is done
+      store->items[existing].calendarIndex = -1;
+      removed = true;
+    } else {
+      store->items[existing] = store->items[index];
+      store->details[existing] = store->details[index];
+      localize_event(&store->items[existing]);
+    }
+    store->count--;
+  } else if (cancelled) {
+    store->count--;
+  }
+  return removed;
+}
+
+// A token can't be truncated: a cut page token ends pagination early and a
+// cut sync token is rejected on the next sync. One that doesn't fit fails
+// the whole response.
+static bool read_response_token(const JsonToken *val, char *out,
+                                size_t size) {
+  if (val->length >= size) {
+    fprintf(stderr, "Response token too long (%zu bytes)\n", val->length);
+    return false;
+  }
+  JsonToken_DecodeString(val, out);
+  return true;
+}
+
+// Streams a Google Calendar events response (or a file in the same format)
+// into store without building a DOM.
+bool load_events_from_json(EventStore *store, const char *json, int calIndex,
+                           int window, bool delta, EventsResponseInfo *info) {
+  int firstIndex = store->count;
+  if (info)
+    info->nextSyncToken[0] = info->nextPageToken[0] = '\0';
+
+  JsonReader r;
+  JsonReader_Init(&r, json, strlen(json));
+  JsonToken tok, val;
+  if (JsonReader_Next(&r, &tok) != JSON_TOK_OBJECT_BEGIN) {
+    fprintf(stderr, "Malformed events JSON\n");
+    return false;
+  }
+
+  IdMap ids = {0};
+  bool anyRemoved = false;
+  bool ok = true;
+  while (ok && JsonReader_Next(&r, &tok) == JSON_TOK_STRING) {
+    if (JsonReader_Next(&r, &val) == JSON_TOK_ERROR) {
+      ok = false;
+    } else {
+      switch ((ResponseField)field_lookup(&tok, k_responseFields,
+                                          RESPONSE_FIELD_COUNT)) {
+      case RESPONSE_ITEMS: {
+        if (val.type != JSON_TOK_ARRAY_BEGIN) {
+          ok = JsonReader_SkipValue(&r, &val);
+          break;
         }
-      } else {
-        const cJSON *d = cJSON_GetObjectItemCaseSensitive(end, "date");
-        if (cJSON_IsString(d) && d->valuestring) {
-          parse_date(d->valuestring, &ev.endYear, &ev.endMon, &ev.endMday);
+        JsonToken item;
+        while (ok && JsonReader_Next(&r, &item) != JSON_TOK_ARRAY_END) {
+          if (item.type == JSON_TOK_OBJECT_BEGIN) {
+            bool cancelled = false;
+            ok = parse_event(&r, store, calIndex, window, &cancelled);
+            if (ok && merge_item(store, &ids, firstIndex, calIndex, window,
+                                 delta, cancelled))
+              anyRemoved = true;
+          } else {
+            ok = JsonReader_SkipValue(&r, &item);
+          }
         }
+        break;
+      }
+      case RESPONSE_NEXT_SYNC_TOKEN:
+        if (info && val.type == JSON_TOK_STRING)
+          ok = read_response_token(&val, info->nextSyncToken,
+                                   sizeof(info->nextSyncToken));
+        else
+          ok = JsonReader_SkipValue(&r, &val);
+        break;
+      case RESPONSE_NEXT_PAGE_TOKEN:
+        if (info && val.type == JSON_TOK_STRING)
+          ok = read_response_token(&val, info->nextPageToken,
+                                   sizeof(info->nextPageToken));
+        else
+          ok = JsonReader_SkipValue(&r, &val);
+        break;
+      default:
+        ok = JsonReader_SkipValue(&r, &val);
+        break;
       }
     }
+  }
+  free(ids.slots);
+
+  if (!ok || tok.type != JSON_TOK_OBJECT_END) {
+    fprintf(stderr, "Malformed events JSON\n");
+    // Strings already pushed stay in the arena until the next clear
+    if (store->count > firstIndex)
+      store->count = firstIndex;
+    if (anyRemoved)
+      EventStore_RemoveCalendar(store, -1);
+    store->generation++;
+    if (info)
+      info->nextSyncToken[0] = info->nextPageToken[0] = '\0';
+    return false;
+  }
 
-    g_events[g_eventCount++] = ev;
+  if (anyRemoved) {
+    int before = store->count;
+    EventStore_RemoveCalendar(store, -1);
+    // Removed slots all sat below firstIndex
+    firstIndex -= before - store->count;
   }
+  EventStore_Localize(store, firstIndex);
+  return true;
+}
+
+bool events_peek_page_token(const char *json, size_t len, char *out,
+                            size_t outSize) {
+  JsonReader r;
+  JsonReader_Init(&r, json, len);
+  JsonToken key, val;
+  if (JsonReader_Next(&r, &key) != JSON_TOK_OBJECT_BEGIN)
+    return false;
 
-  cJSON_Delete(root);
+  while (JsonReader_Next(&r, &key) == JSON_TOK_STRING) {
+    JsonReader_Next(&r, &val);
+    if (val.type == JSON_TOK_ERROR || val.type == JSON_TOK_END)
+      return false; // Value not fully received yet
+    int field = field_lookup(&key, k_responseFields, RESPONSE_FIELD_COUNT);
+    if (field == RESPONSE_NEXT_PAGE_TOKEN) {
+      if (val.type != JSON_TOK_STRING) {
+        out[0] = '\0';
+        return true;
+      }
+      // Too long to hold: leave it to the full parse, which fails
+      if (val.length >= outSize)
+        return false;
+      JsonToken_DecodeString(&val, out);
+      return true;
+    }
+    if (field == RESPONSE_ITEMS) {
+      // Unusual order: the token, if any, follows the items
+      return false;
+    }
+    if (!JsonReader_SkipValue(&r, &val))
+      return false;
+  }
+  // Reached the end of the object without seeing it
+  if (key.type == JSON_TOK_OBJECT_END) {
+    out[0] = '\0';
+    return true;
+  }
+  return false;
 }
 
-static void load_events_from_file(const char *path, int calIndex) {
+static void load_events_from_file(EventStore *store, const char *path,
+                                  int calIndex) {
   FILE *f = fopen(path, "r");
   if (!f) {
     fprintf(stderr, "Could not open %s\n", path);
@@ -176,31 +837,279 @@ static void load_events_from_file(const char *path, int calIndex) {
   buf[nread] = '\0';
   fclose(f);
 
-  load_events_from_json(buf, calIndex);
+  load_events_from_json(store, buf, calIndex, CAL_WINDOW_ALL, false, NULL);
   free(buf);
 }
 
-void Calendar_LoadEvents(void) {
-  if (g_eventsLoaded)
+// What a file calendar looked like when it was last read
+typedef struct {
+  bool read;
+  bool exists;
+  time_t mtime;
+  long mtimeNsec;
+  off_t size;
+} FileStamp;
+
+static FileStamp file_stamp(const char *path) {
+  struct stat st;
+  FileStamp stamp = {true, stat(path, &st) == 0, 0, 0, 0};
+  if (stamp.exists) {
+    stamp.mtime = st.st_mtim.tv_sec;
+    stamp.mtimeNsec = st.st_mtim.tv_nsec;
+    stamp.size = st.st_size;
+  }
+  return stamp;
+}
+
+// Reread calendars[i] into store unless the file is unchanged since
+// *stamp was taken
+static void reload_file_calendar(EventStore *store, const char *path,
+                                 int calIndex, FileStamp *stamp, bool force) {
+  FileStamp now = file_stamp(path);
+  if (!force && stamp->read && now.exists == stamp->exists &&
+      now.mtime == stamp->mtime && now.mtimeNsec == stamp->mtimeNsec &&
+      now.size == stamp->size)
     return;
-  g_eventsLoaded = true;
-  g_eventCount = 0;
+  *stamp = now;
+  EventStore_RemoveCalendar(store, calIndex);
+  load_events_from_file(store, path, calIndex);
+}
 
-  if (g_calendarCount == 0)
-    Calendar_InitCalendars();
+// What the user is looking at: the primary calendar (always first in a
+// discovered list) and every visible one
+static bool on_screen(const LinkedCalendar *cal) {
+  return cal->visible || strcmp(cal->calendarId, "primary") == 0;
+}
 
-  for (int i = 0; i < g_calendarCount; i++) {
-    if (g_calendars[i].source == CAL_SOURCE_FILE) {
-      load_events_from_file(g_calendars[i].filePath, i);
-    } else if (g_calendars[i].source == CAL_SOURCE_GOOGLE) {
-      GoogleCalendar_FetchEvents(g_calendars[i].calendarId, i);
+void Calendar_LoadCalendars(EventStore *store, const LinkedCalendar *calendars,
+                            int count, const int *weeks, int weekCount,
+                            CalendarSyncPhase phase, const bool *reload) {
+  // Events carry their calendar's index, so when the list changes they are
+  // renumbered to match it. Only calendars that left the list lose their
+  // events and sync state.
+  static LinkedCalendar *lastCalendars = NULL;
+  static FileStamp *stamps = NULL; // Per calendar; unused for Google ones
+  static int lastCount = -1;
+  bool changed = count != lastCount;
+  for (int i = 0; !changed && i < count; i++)
+    changed = !same_calendar(&calendars[i], &lastCalendars[i]);
+  if (changed) {
+    int oldCount = lastCount > 0 ? lastCount : 0;
+    LinkedCalendar *copy =
+        malloc(sizeof(LinkedCalendar) * (size_t)(count + 1));
+    FileStamp *moved = calloc((size_t)count + 1, sizeof(FileStamp));
+    int *newIndex = malloc(sizeof(int) * (size_t)(oldCount + 1));
+    if (!copy || !moved || !newIndex) {
+      free(copy);
+      free(moved);
+      free(newIndex);
+      return;
     }
+    memcpy(copy, calendars, sizeof(LinkedCalendar) * (size_t)count);
+
+    if (lastCount < 0) {
+      // On the first sync, pick up where the last run left off: cached
+      // events stay in place if the network is down, and the saved sync
+      // tokens make the fetch below a delta
+      EventStore_Clear(store);
+      GoogleCalendar_ResetSync();
+      EventCache_Load(store, calendars, count, true);
+    } else {
+      for (int i = 0; i < oldCount; i++) {
+        const LinkedCalendar *now =
+            find_calendar(calendars, count, &lastCalendars[i]);
+        newIndex[i] = now ? (int)(now - calendars) : -1;
+        if (now)
+          moved[newIndex[i]] = stamps[i];
+        else if (lastCalendars[i].source == CAL_SOURCE_GOOGLE)
+          GoogleCalendar_ResetCalendar(lastCalendars[i].calendarId);
+      }
+      EventStore_RemapCalendars(store, newIndex, oldCount);
+    }
+    free(newIndex);
+    free(lastCalendars);
+    free(stamps);
+    lastCalendars = copy;
+    stamps = moved;
+    lastCount = count;
+  }
+
+  for (int i = 0; reload && i < count; i++) {
+    if (!reload[i])
+      continue;
+    if (calendars[i].source == CAL_SOURCE_GOOGLE) {
+      EventStore_RemoveCalendar(store, i);
+      GoogleCalendar_ResetCalendar(calendars[i].calendarId);
+    } else {
+      // A reload can join a job of any phase, and the on-screen one skips
+      // files that didn't change
+      reload_file_calendar(store, calendars[i].filePath, i, &stamps[i], true);
+    }
+  }
+
+  size_t maxTargets = (size_t)count * (size_t)weekCount + 1;
+  GoogleFetchTarget *targets = malloc(sizeof(GoogleFetchTarget) * maxTargets);
+  if (!targets)
+    return;
+  int n = 0;
+
+  if (phase == CAL_SYNC_ON_SCREEN) {
+    for (int i = 0; i < count; i++) {
+      if (calendars[i].source == CAL_SOURCE_FILE) {
+        reload_file_calendar(store, calendars[i].filePath, i, &stamps[i],
+                             false);
+      } else if (on_screen(&calendars[i]) && weekCount > 0) {
+        targets[n++] =
+            (GoogleFetchTarget){calendars[i].calendarId, i, weeks[0]};
+      }
+    }
+  } else if (phase == CAL_SYNC_RELOAD) {
+    for (int w = 0; w < weekCount; w++) {
+      for (int i = 0; i < count; i++) {
+        // Reloaded file calendars were read above
+        if (!reload || !reload[i] || calendars[i].source != CAL_SOURCE_GOOGLE)
+          continue;
+        targets[n++] =
+            (GoogleFetchTarget){calendars[i].calendarId, i, weeks[w]};
+      }
+    }
+  } else {
+    // The viewed week's remaining calendars, then the neighbouring weeks
+    // with the visible calendars leading each
+    for (int w = 0; w < weekCount; w++) {
+      for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < count; i++) {
+          const LinkedCalendar *cal = &calendars[i];
+          if (cal->source != CAL_SOURCE_GOOGLE || on_screen(cal) != (pass == 0))
+            continue;
+          if (w == 0 && pass == 0 && !(reload && reload[i]))
+            continue; // Done in the on-screen phase
+          targets[n++] = (GoogleFetchTarget){cal->calendarId, i, weeks[w]};
+        }
+      }
+    }
+  }
+
+  // All targets share connections, each a delta where possible
+  GoogleCalendar_FetchAll(store, targets, n);
+  free(targets);
+  // Trim the week cache once every requested week is in
+  if (phase == CAL_SYNC_BACKGROUND)
+    GoogleCalendar_EvictWeeks(store, weeks, weekCount);
+}
+
+// Sync the viewed week first, then its neighbours so flipping is instant
+static void request_sync(int viewWeek, bool discover) {
+  int weeks[CAL_PREFETCH_WEEKS] = {viewWeek, viewWeek + 7, viewWeek - 7};
+  SyncWorker_Request(g_calendars, g_calendarCount, weeks, CAL_PREFETCH_WEEKS,
+                     discover);
+}
+
+// Link the calendars the cached events were synced with, if they still
+// include everything linked now (they won't after switching accounts)
+static void adopt_cached_calendars(void) {
+  LinkedCalendar *cached;
+  int cachedCount;
+  if (g_calendarCount == 0 || !EventCache_LoadCalendars(&cached, &cachedCount))
+    return;
+  bool covers = true;
+  for (int i = 0; covers && i < g_calendarCount; i++)
+    covers = find_calendar(cached, cachedCount, &g_calendars[i]) != NULL;
+  if (covers) {
+    // Visibility comes from the cache, not the defaults just set up
+    g_calendarCount = 0;
+    Calendar_SetCalendars(cached, cachedCount);
   }
+  free(cached);
 }
 
+// Keep the scheduler's view of the next event current and ask it, at most
+// once a second, whether the calendars are due for another poll
+static bool poll_due(void) {
+  static time_t lastCheck = 0;
+  static time_t lastScan = 0;
+  static const EventStore *scannedStore = NULL;
+  static uint32_t scannedGeneration = 0;
+  time_t now = time(NULL);
+  if (now == lastCheck)
+    return false;
+  lastCheck = now;
+
+  if (g_eventStore != scannedStore ||
+      g_eventStore->generation != scannedGeneration || now - lastScan >= 60) {
+    scannedStore = g_eventStore;
+    scannedGeneration = g_eventStore->generation;
+    lastScan = now;
+    time_t next = 0;
+    for (int i = 0; i < g_eventStore->count; i++) {
+      const CalEvent *ev = &g_eventStore->items[i];
+      if (!ev->allDay && ev->startTime >= now && (!next || ev->startTime < next))
+        next = ev->startTime;
+    }
+    RefreshScheduler_SetNextEvent(next);
+  }
+  return !SyncWorker_IsSyncing() && RefreshScheduler_PollDue(now);
+}
+
+void Calendar_LoadEvents(int viewWeek) {
+  LinkedCalendar *calendars;
+  int count;
+  g_eventStore = SyncWorker_Swap(g_eventStore, &calendars, &count);
+  if (calendars) {
+    Calendar_SetCalendars(calendars, count);
+    free(calendars);
+  }
+
+  static int requestedWeek = 0;
+  if (g_eventsLoaded) {
+    if (viewWeek != requestedWeek) {
+      requestedWeek = viewWeek;
+      request_sync(viewWeek, false);
+    } else if (poll_due()) {
+      request_sync(viewWeek, false);
+    }
+    return;
+  }
+  g_eventsLoaded = true;
+
+  Calendar_InitCalendars();
+
+  // Show the last run's calendars and events on the very first frame; the
+  // sync below replaces them once it lands
+  static bool cacheTried = false;
+  if (!cacheTried) {
+    cacheTried = true;
+    adopt_cached_calendars();
+    EventCache_Load(g_eventStore, g_calendars, g_calendarCount, false);
+  }
+
+  // Falls back to loading inline (still published via the swap) if the
+  // thread can't be created
+  static bool workerStarted = false;
+  if (!workerStarted) {
+    SyncWorker_Start(&s_stores[1]);
+    workerStarted = true;
+  }
+  requestedWeek = viewWeek;
+  // A fresh start or reload looks for calendars added since
+  request_sync(viewWeek, true);
+}
+
+// Picked up by the next frame's Calendar_LoadEvents. The current events stay
+// on screen until the new sync is swapped in.
 void Calendar_ReloadEvents(void) {
   g_eventsLoaded = false;
-  g_eventCount = 0;
-  g_calendarCount = 0;
-  Calendar_LoadEvents();
+}
+
+void Calendar_ReloadCalendar(int calIndex) {
+  if (calIndex < 0 || calIndex >= g_calendarCount)
+    return;
+  // Before the first sync everything is about to be fetched anyway
+  if (!g_eventsLoaded)
+    return;
+  SyncWorker_RequestReload(g_calendars, g_calendarCount, calIndex);
+}
+
+bool Calendar_IsSyncing(void) {
+  return SyncWorker_IsSyncing();
 }
@@ -1,19 +1,23 @@
 #ifndef EVENTS_H
 #define EVENTS_H
 
+#include "arena.h"
+#include "event_index.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 #include <time.h>
 
-#define CAL_MAX_EVENTS 256
-#define CAL_SUMMARY_LEN 64
-#define CAL_DESC_LEN   256
-#define CAL_LOC_LEN    128
-
-#define CAL_MAX_CALENDARS 8
 #define CAL_NAME_LEN      32
 #define CAL_PATH_LEN     128
 #define CAL_CALID_LEN    128
+#define CAL_SYNC_TOKEN_LEN 256
+
+// Google events are fetched per week; each event remembers the week window
+// (Monday's day number) it came from. File calendars aren't windowed.
+#define CAL_WINDOW_ALL INT32_MIN
+// Weeks fetched around the viewed one: the week itself, then its neighbours
+#define CAL_PREFETCH_WEEKS 3
 
 typedef enum {
   CAL_SOURCE_FILE,
@@ -31,31 +35,160 @@ typedef struct {
   bool    visible;
 } LinkedCalendar;
 
+// Hot per-event record: everything bucketing and layout touch each frame.
+// Strings point into the owning EventStore's arena and are never NULL; the
+// summary's length is kept so the renderer can hand it to Clay as is.
+//
+// Days are proleptic Gregorian day numbers (DateTime_DaysFromCivil) so the
+// week view can bucket and place events with integer math alone. For timed
+// events they and the minute fields are local time, filled in by
+// EventStore_Localize; all-day events cover [startDay, endDay) and don't
+// depend on the time zone.
 typedef struct {
-  char summary[CAL_SUMMARY_LEN];
-  char description[CAL_DESC_LEN];
-  char location[CAL_LOC_LEN];
-  bool allDay;
   // For timed events: UTC epoch
   time_t startTime;
   time_t endTime;
-  // For all-day events: year/mon/mday (1-indexed month)
-  int startYear, startMon, startMday;
-  int endYear,   endMon,   endMday;
+  const char *summary;
+  int32_t summaryLength; // Bytes, without the NUL
+  int startDay;
+  int endDay;
+  int16_t startMinute; // Local minute of day, timed events only
+  int16_t endMinute;
   int colorId;  // 0 = default blue
   int calendarIndex;
+  int window;   // Week it was fetched for, or CAL_WINDOW_ALL
+  bool allDay;
 } CalEvent;
 
-extern CalEvent g_events[CAL_MAX_EVENTS];
-extern int      g_eventCount;
-extern bool     g_eventsLoaded;
+// Cold per-event data, only read when an event's detail popup is open or
+// when a sync merges changes
+typedef struct {
+  const char *description;
+  const char *location;
+  const char *id; // Google event id, "" for events without one
+} CalEventDetail;
+
+// Growable event arrays. items[i] and details[i] describe the same event.
+// Storage lives in the store's arena, so growing leaves the old copy behind
+// until EventStore_Clear frees everything in one go.
+typedef struct {
+  CalEvent       *items;
+  CalEventDetail *details;
+  int             count;
+  int             capacity;
+  long            utcOffset; // Zone offset the timed events were localized in
+  Arena           arena;
+  // Bumped on every change to items; caches compare against it
+  uint32_t        generation;
+  // Day-span index over items, rebuilt lazily on the first query after a
+  // change
+  EventIndex      index;
+  uint32_t        indexGeneration;
+} EventStore;
 
-extern LinkedCalendar g_calendars[CAL_MAX_CALENDARS];
-extern int            g_calendarCount;
+// Store the renderer reads from. Swapped for the sync worker's freshly
+// loaded store by Calendar_LoadEvents; never written by the worker.
+extern EventStore *g_eventStore;
+extern bool        g_eventsLoaded;
+
+// Linked calendars, indexed by CalEvent.calendarIndex of g_eventStore.
+// Grows as needed; replaced by the list each finished sync was made with.
+extern LinkedCalendar *g_calendars;
+extern int             g_calendarCount;
+
+// Appends a zeroed event and returns its index, or -1 on allocation failure
+int  EventStore_Append(EventStore *store);
+void EventStore_Clear(EventStore *store);
+const CalEventDetail *EventStore_GetDetail(const EventStore *store, int index);
+// Recompute local day/minute fields of timed events in [first, store->count)
+// (all of them if the zone offset changed since the last call)
+void EventStore_Localize(EventStore *store, int first);
+// Drop events, keeping the rest in order: every event of one calendar, one
+// calendar's events from one week window, or all events of a window
+void EventStore_RemoveCalendar(EventStore *store, int calIndex);
+void EventStore_RemoveCalendarWindow(EventStore *store, int calIndex,
+                                     int window);
+void EventStore_RemoveWindow(EventStore *store, int window);
+// Renumber events after the calendar list changed: calendar i becomes
+// newIndex[i] (i < count), and events of calendars mapped to -1 are dropped
+void EventStore_RemapCalendars(EventStore *store, const int *newIndex,
+                               int count);
+// Replace dst with a compacted deep copy of src (strings included)
+bool EventStore_CopyFrom(EventStore *dst, const EventStore *src);
+// Append the indices of events displayed on any day in [firstDay, endDay).
+// All-day events cover [startDay, endDay); timed events show on startDay.
+void EventStore_QueryDays(EventStore *store, int firstDay, int endDay,
+                          EventIndexResult *out);
 
 void Calendar_InitCalendars(void);
-void Calendar_LoadEvents(void);
+// Replace g_calendars with calendars[0..count), keeping the visibility the
+// user gave calendars that were already listed
+void Calendar_SetCalendars(const LinkedCalendar *calendars, int count);
+// The list to sync: every calendar in the user's Google calendarList,
+// primary first, then base's file calendars. Calendars already in base keep
+// their visibility; if base links no Google calendar none are added.
+// Returns a malloc'd list, or NULL if the calendar list couldn't be fetched
+// (blocking).
+LinkedCalendar *Calendar_DiscoverCalendars(const LinkedCalendar *base,
+                                           int baseCount, int *count);
+// Called every frame with the Monday of the week on screen: picks up
+// finished syncs and requests one whenever the viewed week changes or the
+// refresh scheduler says a poll is due
+void Calendar_LoadEvents(int viewWeek);
+// After signing in or out: link or drop the Google calendars, rediscover
+// them, and sync. File calendars, visibility and the events of calendars
+// still linked are kept.
 void Calendar_ReloadEvents(void);
-void load_events_from_json(const char *json, int calIndex);
+// Refetch one calendar from scratch, leaving every other calendar's events
+// as they are. Repeated reloads of a calendar within a couple of seconds
+// are merged into the one already queued or running.
+void Calendar_ReloadCalendar(int calIndex);
+bool Calendar_IsSyncing(void);
+
+// A sync runs in two phases so a long calendar list doesn't hold back what
+// is on screen: first the primary and visible calendars for the viewed week
+// (weeks[0]) plus file calendars, then everything else. A reload on its own
+// is a single phase covering only the reloaded calendars.
+typedef enum {
+  CAL_SYNC_ON_SCREEN,
+  CAL_SYNC_BACKGROUND,
+  CAL_SYNC_RELOAD,
+} CalendarSyncPhase;
+
+// Bring store up to date with calendars[0..count), tagging events with their
+// array index, fetching Google calendars for each week in weeks[]. store
+// persists between calls so Google calendars can sync incrementally and
+// other weeks stay cached (blocking; run from the sync worker).
+//
+// Calendars flagged in reload (NULL for none) first lose their events and
+// sync state, so they are fetched in full; CAL_SYNC_RELOAD fetches only
+// those.
+void Calendar_LoadCalendars(EventStore *store, const LinkedCalendar *calendars,
+                            int count, const int *weeks, int weekCount,
+                            CalendarSyncPhase phase, const bool *reload);
+// Top-level fields of an events response
+typedef struct {
+  char nextSyncToken[CAL_SYNC_TOKEN_LEN]; // "" if absent
+  char nextPageToken[CAL_SYNC_TOKEN_LEN]; // "" on the last page
+} EventsResponseInfo;
+
+// Parse an events response into store, tagging events with calIndex and
+// window. With delta set the response is an incremental sync: items replace
+// that calendar window's events with the same id and cancelled items delete
+// them, as do items that no longer fall in the window; otherwise items are
+// appended and cancelled ones skipped. info may be NULL. Returns false on malformed input, which
+// adds nothing in full mode but may leave a delta half applied.
+bool load_events_from_json(EventStore *store, const char *json, int calIndex,
+                           int window, bool delta, EventsResponseInfo *info);
+// The fields= mask selecting exactly the keys load_events_from_json reads,
+// generated from the same table the parser dispatches on. Returns the
+// mask's length; like snprintf, out holds all of it only if that is < size.
+size_t events_fields_mask(char *out, size_t size);
+// Look for nextPageToken in the first len bytes of a response that is still
+// downloading. Google sends it ahead of "items", so the next page can be
+// requested long before this one is complete. Returns false while that
+// can't be decided yet; otherwise out is the token, or "" if there is none.
+bool events_peek_page_token(const char *json, size_t len, char *out,
+                            size_t outSize);
 
 #endif
@@ -1,9 +1,11 @@
 #include "google_auth.h"
 #include "cJSON.h"
 #include "config_dir.h"
+#include "http_client.h"
 
-#include <curl/curl.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,32 +18,40 @@
 static char s_redirectUri[128] = "";
 static const char *GOOGLE_SCOPE =
     "https://www.googleapis.com/auth/calendar.readonly";
+static const char *GOOGLE_TOKEN_URL = "https://oauth2.googleapis.com/token";
+
+// Refresh this long before the access token expires
+#define GOOGLE_REFRESH_AHEAD 300
+// Treat a token this close to expiry as already expired (clock skew)
+#define GOOGLE_EXPIRY_SKEW 10
+// Retry delay after a failed background refresh, doubling up to the cap
+#define GOOGLE_RETRY_SECS 30
+#define GOOGLE_RETRY_MAX_SECS 300
 
 // ── Global state ─────────────────────────────────────────────────────────────
-GoogleTokens g_googleTokens = {0};
-GoogleAuthState g_authState = AUTH_READY;
-char g_authErrorMsg[GOOGLE_AUTH_ERR_MAX] = {0};
 char g_authUrl[GOOGLE_AUTH_URL_MAX] = {0};
 
-// ── libcurl write callback ───────────────────────────────────────────────────
-typedef struct {
-  char *data;
-  size_t size;
-} CurlBuffer;
-
-static size_t curl_write_cb(void *ptr, size_t size, size_t nmemb,
-                            void *userdata) {
-  size_t total = size * nmemb;
-  CurlBuffer *buf = (CurlBuffer *)userdata;
-  char *tmp = realloc(buf->data, buf->size + total + 1);
-  if (!tmp)
-    return 0;
-  buf->data = tmp;
-  memcpy(buf->data + buf->size, ptr, total);
-  buf->size += total;
-  buf->data[buf->size] = '\0';
-  return total;
-}
+// Every read and write of s_tokens, s_authState and s_authError holds
+// s_tokenMutex, so fetchers always copy out a complete token and the UI a
+// complete message
+static GoogleTokens s_tokens = {0};
+static GoogleAuthState s_authState = AUTH_READY;
+static char s_authError[GOOGLE_AUTH_ERR_MAX] = {0};
+static pthread_mutex_t s_tokenMutex = PTHREAD_MUTEX_INITIALIZER;
+// Signalled when a refresh finishes (s_refreshDone bumped)
+static pthread_cond_t s_refreshCond = PTHREAD_COND_INITIALIZER;
+static bool s_refreshing = false; // A refresh request is in flight
+static bool s_refreshOk = false;  // Result of the last one to finish
+static uint32_t s_refreshDone = 0;
+// Bumped when the account changes, so an in-flight refresh for the old
+// one is thrown away
+static uint32_t s_tokenEpoch = 0;
+
+// Background refresher, also guarded by s_tokenMutex
+static pthread_t s_refresher;
+static pthread_cond_t s_refresherCond = PTHREAD_COND_INITIALIZER;
+static bool s_refresherRunning = false;
+static bool s_refresherStop = false;
 
 static void get_tokens_path(char *buf, size_t bufsize) {
   char dir[256];
@@ -50,6 +60,7 @@ static void get_tokens_path(char *buf, size_t bufsize) {
 }
 
 // ── Token persistence ────────────────────────────────────────────────────────
+// Both run with s_tokenMutex held (or before any other thread exists)
 static bool load_tokens(void) {
   char path[512];
   get_tokens_path(path, sizeof(path));
@@ -89,16 +100,16 @@ static bool load_tokens(void) {
   const cJSON *ex = cJSON_GetObjectItemCaseSensitive(root, "expires_at");
 
   if (cJSON_IsString(at) && at->valuestring)
-    strncpy(g_googleTokens.access_token, at->valuestring,
-            sizeof(g_googleTokens.access_token) - 1);
+    strncpy(s_tokens.access_token, at->valuestring,
+            sizeof(s_tokens.access_token) - 1);
   if (cJSON_IsString(rt) && rt->valuestring)
-    strncpy(g_googleTokens.refresh_token, rt->valuestring,
-            sizeof(g_googleTokens.refresh_token) - 1);
+    strncpy(s_tokens.refresh_token, rt->valuestring,
+            sizeof(s_tokens.refresh_token) - 1);
   if (cJSON_IsNumber(ex))
-    g_googleTokens.expires_at = (time_t)ex->valuedouble;
+    s_tokens.expires_at = (time_t)ex->valuedouble;
 
   cJSON_Delete(root);
-  return g_googleTokens.refresh_token[0] != '\0';
+  return s_tokens.refresh_token[0] != '\0';
 }
 
 static void save_tokens(void) {
@@ -108,10 +119,10 @@ static void save_tokens(void) {
   get_tokens_path(path, sizeof(path));
 
   cJSON *root = cJSON_CreateObject();
-  cJSON_AddStringToObject(root, "access_token", g_googleTokens.access_token);
-  cJSON_AddStringToObject(root, "refresh_token", g_googleTokens.refresh_token);
+  cJSON_AddStringToObject(root, "access_token", s_tokens.access_token);
+  cJSON_AddStringToObject(root, "refresh_token", s_tokens.refresh_token);
   cJSON_AddNumberToObject(root, "expires_at",
-                          (double)g_googleTokens.expires_at);
+                          (double)s_tokens.expires_at);
 
   char *json = cJSON_PrintUnformatted(root);
   cJSON_Delete(root);
@@ -132,10 +143,11 @@ static void save_tokens(void) {
 }
 
 // ── Parse token response JSON ────────────────────────────────────────────────
+// Called with s_tokenMutex held
 static bool parse_token_response(const char *json) {
   cJSON *root = cJSON_Parse(json);
   if (!root) {
-    snprintf(g_authErrorMsg, GOOGLE_AUTH_ERR_MAX,
+    snprintf(s_authError, sizeof(s_authError),
              "Failed to parse token response");
     return false;
   }
@@ -144,7 +156,7 @@ static bool parse_token_response(const char *json) {
   if (cJSON_IsString(err) && err->valuestring) {
     const cJSON *desc =
         cJSON_GetObjectItemCaseSensitive(root, "error_description");
-    snprintf(g_authErrorMsg, GOOGLE_AUTH_ERR_MAX, "%s: %s", err->valuestring,
+    snprintf(s_authError, sizeof(s_authError), "%s: %s", err->valuestring,
              (cJSON_IsString(desc) && desc->valuestring) ? desc->valuestring
                                                          : "");
     cJSON_Delete(root);
@@ -153,33 +165,182 @@ static bool parse_token_response(const char *json) {
 
   const cJSON *at = cJSON_GetObjectItemCaseSensitive(root, "access_token");
   if (cJSON_IsString(at) && at->valuestring)
-    strncpy(g_googleTokens.access_token, at->valuestring,
-            sizeof(g_googleTokens.access_token) - 1);
+    strncpy(s_tokens.access_token, at->valuestring,
+            sizeof(s_tokens.access_token) - 1);
 
   const cJSON *rt = cJSON_GetObjectItemCaseSensitive(root, "refresh_token");
   if (cJSON_IsString(rt) && rt->valuestring)
-    strncpy(g_googleTokens.refresh_token, rt->valuestring,
-            sizeof(g_googleTokens.refresh_token) - 1);
+    strncpy(s_tokens.refresh_token, rt->valuestring,
+            sizeof(s_tokens.refresh_token) - 1);
 
   const cJSON *ei = cJSON_GetObjectItemCaseSensitive(root, "expires_in");
   if (cJSON_IsNumber(ei))
-    g_googleTokens.expires_at = time(NULL) + (time_t)ei->valueint;
+    s_tokens.expires_at = time(NULL) + (time_t)ei->valueint;
 
   cJSON_Delete(root);
   return true;
 }
 
+// ── Coalesced refresh ────────────────────────────────────────────────────────
+// One refresh request at a time: a caller arriving while one is in flight
+// waits for it and shares its result instead of sending another
+static bool refresh_coalesced(void) {
+  pthread_mutex_lock(&s_tokenMutex);
+  if (s_refreshing) {
+    uint32_t seen = s_refreshDone;
+    while (s_refreshDone == seen)
+      pthread_cond_wait(&s_refreshCond, &s_tokenMutex);
+    bool ok = s_refreshOk;
+    pthread_mutex_unlock(&s_tokenMutex);
+    return ok;
+  }
+  if (s_tokens.refresh_token[0] == '\0') {
+    s_authState = AUTH_READY;
+    pthread_mutex_unlock(&s_tokenMutex);
+    return false;
+  }
+
+  char postfields[2048];
+  snprintf(postfields, sizeof(postfields),
+           "refresh_token=%s"
+           "&client_id=%s"
+           "&client_secret=%s"
+           "&grant_type=refresh_token",
+           s_tokens.refresh_token, GOOGLE_CLIENT_ID, GOOGLE_CLIENT_SECRET);
+  uint32_t epoch = s_tokenEpoch;
+  s_refreshing = true;
+  pthread_mutex_unlock(&s_tokenMutex);
+
+  HttpBuffer response = {0};
+  CURLcode res = HttpClient_Post(GOOGLE_TOKEN_URL, postfields, &response, NULL);
+
+  pthread_mutex_lock(&s_tokenMutex);
+  bool ok = res == CURLE_OK && response.data && epoch == s_tokenEpoch &&
+            parse_token_response(response.data);
+  if (ok)
+    save_tokens();
+  s_refreshing = false;
+  s_refreshOk = ok;
+  s_refreshDone++;
+  pthread_cond_broadcast(&s_refreshCond);
+  // The refresher sleeps until shortly before the new expiry
+  pthread_cond_signal(&s_refresherCond);
+  pthread_mutex_unlock(&s_tokenMutex);
+  free(response.data);
+  return ok;
+}
+
+// ── Background refresher ─────────────────────────────────────────────────────
+// Renews the access token GOOGLE_REFRESH_AHEAD seconds before it expires,
+// so fetches find a valid one instead of paying for the round trip
+static void *refresher_thread(void *arg) {
+  (void)arg;
+  time_t retryAt = 0;
+  long retryDelay = 0;
+
+  pthread_mutex_lock(&s_tokenMutex);
+  while (!s_refresherStop) {
+    time_t due = 0; // 0 = nothing to refresh
+    if (s_tokens.refresh_token[0]) {
+      due = s_tokens.expires_at - GOOGLE_REFRESH_AHEAD;
+      if (retryAt > due)
+        due = retryAt;
+    }
+    if (due && !s_refreshing && time(NULL) >= due) {
+      pthread_mutex_unlock(&s_tokenMutex);
+      bool ok = refresh_coalesced();
+      pthread_mutex_lock(&s_tokenMutex);
+      if (ok) {
+        retryDelay = 0;
+        retryAt = 0;
+      } else {
+        retryDelay = retryDelay ? retryDelay * 2 : GOOGLE_RETRY_SECS;
+        if (retryDelay > GOOGLE_RETRY_MAX_SECS)
+          retryDelay = GOOGLE_RETRY_MAX_SECS;
+        retryAt = time(NULL) + retryDelay;
+        fprintf(stderr, "Token refresh failed, retrying in %lds\n",
+                retryDelay);
+      }
+      continue;
+    }
+
+    if (due && !s_refreshing) {
+      struct timespec until = {due, 0};
+      pthread_cond_timedwait(&s_refresherCond, &s_tokenMutex, &until);
+    } else {
+      pthread_cond_wait(&s_refresherCond, &s_tokenMutex);
+    }
+  }
+  pthread_mutex_unlock(&s_tokenMutex);
+  return NULL;
+}
+
 // ── Public API ───────────────────────────────────────────────────────────────
 
 void GoogleAuth_Init(void) {
-  memset(&g_googleTokens, 0, sizeof(g_googleTokens));
-  g_authState = AUTH_READY;
-  g_authErrorMsg[0] = '\0';
-  if (load_tokens()) {
-    g_authState = AUTH_AUTHENTICATED;
+  pthread_mutex_lock(&s_tokenMutex);
+  memset(&s_tokens, 0, sizeof(s_tokens));
+  s_authState = load_tokens() ? AUTH_AUTHENTICATED : AUTH_READY;
+  s_authError[0] = '\0';
+  pthread_mutex_unlock(&s_tokenMutex);
+
+  if (!s_refresherRunning) {
+    s_refresherStop = false;
+    if (pthread_create(&s_refresher, NULL, refresher_thread, NULL) == 0)
+      s_refresherRunning = true;
+    else
+      fprintf(stderr, "Could not start token refresher, refreshing on "
+                      "demand\n");
   }
 }
 
+void GoogleAuth_Stop(void) {
+  if (!s_refresherRunning)
+    return;
+  pthread_mutex_lock(&s_tokenMutex);
+  s_refresherStop = true;
+  pthread_cond_signal(&s_refresherCond);
+  pthread_mutex_unlock(&s_tokenMutex);
+  // Waits out a refresh already in flight
+  pthread_join(s_refresher, NULL);
+  s_refresherRunning = false;
+}
+
+GoogleAuthState GoogleAuth_GetState(void) {
+  pthread_mutex_lock(&s_tokenMutex);
+  GoogleAuthState state = s_authState;
+  pthread_mutex_unlock(&s_tokenMutex);
+  return state;
+}
+
+void GoogleAuth_GetError(char *out, size_t size) {
+  if (size == 0)
+    return;
+  pthread_mutex_lock(&s_tokenMutex);
+  snprintf(out, size, "%s", s_authError);
+  pthread_mutex_unlock(&s_tokenMutex);
+}
+
+void GoogleAuth_SetState(GoogleAuthState state, const char *error) {
+  pthread_mutex_lock(&s_tokenMutex);
+  s_authState = state;
+  if (error)
+    snprintf(s_authError, sizeof(s_authError), "%s", error);
+  pthread_mutex_unlock(&s_tokenMutex);
+}
+
+bool GoogleAuth_GetAccessToken(char *out, size_t size) {
+  pthread_mutex_lock(&s_tokenMutex);
+  size_t len = strlen(s_tokens.access_token);
+  bool ok = len > 0 && len < size;
+  if (ok)
+    memcpy(out, s_tokens.access_token, len + 1);
+  pthread_mutex_unlock(&s_tokenMutex);
+  if (!ok && size > 0)
+    out[0] = '\0';
+  return ok;
+}
+
 void GoogleAuth_BuildAuthUrlWithRedirect(const char *redirect_uri) {
   strncpy(s_redirectUri, redirect_uri, sizeof(s_redirectUri) - 1);
   s_redirectUri[sizeof(s_redirectUri) - 1] = '\0';
@@ -200,13 +361,6 @@ void GoogleAuth_BuildAuthUrl(void) {
 }
 
 bool GoogleAuth_ExchangeCode(const char *code) {
-  CURL *curl = curl_easy_init();
-  if (!curl) {
-    snprintf(g_authErrorMsg, GOOGLE_AUTH_ERR_MAX, "Failed to initialize curl");
-    g_authState = AUTH_ERROR;
-    return false;
-  }
-
   char postfields[2048];
   snprintf(postfields, sizeof(postfields),
            "code=%s"
@@ -216,93 +370,61 @@ bool GoogleAuth_ExchangeCode(const char *code) {
            "&grant_type=authorization_code",
            code, GOOGLE_CLIENT_ID, GOOGLE_CLIENT_SECRET, s_redirectUri);
 
-  CurlBuffer response = {0};
-
-  curl_easy_setopt(curl, CURLOPT_URL, "https://oauth2.googleapis.com/token");
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postfields);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_cb);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-  CURLcode res = curl_easy_perform(curl);
-  curl_easy_cleanup(curl);
+  HttpBuffer response = {0};
+  CURLcode res = HttpClient_Post(GOOGLE_TOKEN_URL, postfields, &response, NULL);
 
   if (res != CURLE_OK) {
-    snprintf(g_authErrorMsg, GOOGLE_AUTH_ERR_MAX, "HTTP error: %s",
+    pthread_mutex_lock(&s_tokenMutex);
+    snprintf(s_authError, sizeof(s_authError), "HTTP error: %s",
              curl_easy_strerror(res));
+    s_authState = AUTH_ERROR;
+    pthread_mutex_unlock(&s_tokenMutex);
     free(response.data);
-    g_authState = AUTH_ERROR;
     return false;
   }
 
-  bool ok = parse_token_response(response.data);
-  free(response.data);
-
-  if (ok) {
+  pthread_mutex_lock(&s_tokenMutex);
+  s_tokenEpoch++;
+  bool ok = response.data && parse_token_response(response.data);
+  if (ok)
     save_tokens();
-    g_authState = AUTH_AUTHENTICATED;
-  } else {
-    g_authState = AUTH_ERROR;
-  }
+  s_authState = ok ? AUTH_AUTHENTICATED : AUTH_ERROR;
+  // Schedule the new token's refresh
+  pthread_cond_signal(&s_refresherCond);
+  pthread_mutex_unlock(&s_tokenMutex);
+  free(response.data);
   return ok;
 }
 
 bool GoogleAuth_RefreshAccessToken(void) {
-  if (g_googleTokens.refresh_token[0] == '\0') {
-    g_authState = AUTH_READY;
-    return false;
-  }
-
-  CURL *curl = curl_easy_init();
-  if (!curl)
-    return false;
-
-  char postfields[2048];
-  snprintf(postfields, sizeof(postfields),
-           "refresh_token=%s"
-           "&client_id=%s"
-           "&client_secret=%s"
-           "&grant_type=refresh_token",
-           g_googleTokens.refresh_token, GOOGLE_CLIENT_ID,
-           GOOGLE_CLIENT_SECRET);
-
-  CurlBuffer response = {0};
-
-  curl_easy_setopt(curl, CURLOPT_URL, "https://oauth2.googleapis.com/token");
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postfields);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_cb);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-  CURLcode res = curl_easy_perform(curl);
-  curl_easy_cleanup(curl);
-
-  if (res != CURLE_OK) {
-    free(response.data);
-    return false;
-  }
-
-  bool ok = parse_token_response(response.data);
-  free(response.data);
-
-  if (ok) {
-    save_tokens();
-  }
-  return ok;
+  return refresh_coalesced();
 }
 
 bool GoogleAuth_EnsureValidToken(void) {
-  if (g_authState != AUTH_AUTHENTICATED)
+  pthread_mutex_lock(&s_tokenMutex);
+  if (s_authState != AUTH_AUTHENTICATED) {
+    pthread_mutex_unlock(&s_tokenMutex);
     return false;
-  if (g_googleTokens.access_token[0] == '\0')
-    return GoogleAuth_RefreshAccessToken();
-  if (time(NULL) >= g_googleTokens.expires_at - 60)
-    return GoogleAuth_RefreshAccessToken();
-  return true;
+  }
+  bool valid = s_tokens.access_token[0] != '\0' &&
+               time(NULL) < s_tokens.expires_at - GOOGLE_EXPIRY_SKEW;
+  pthread_mutex_unlock(&s_tokenMutex);
+  if (valid)
+    return true;
+  // Only without any usable token (first start, or after the machine
+  // slept through the refresh): nothing can be fetched until one arrives,
+  // so join the refresh, the background one if it is already running
+  return refresh_coalesced();
 }
 
 void GoogleAuth_Disconnect(void) {
-  memset(&g_googleTokens, 0, sizeof(g_googleTokens));
-  g_authState = AUTH_READY;
-  g_authErrorMsg[0] = '\0';
+  pthread_mutex_lock(&s_tokenMutex);
+  memset(&s_tokens, 0, sizeof(s_tokens));
+  s_tokenEpoch++;
+  s_authState = AUTH_READY;
+  s_authError[0] = '\0';
+  pthread_cond_signal(&s_refresherCond);
+  pthread_mutex_unlock(&s_tokenMutex);
 
   char path[512];
   get_tokens_path(path, sizeof(path));
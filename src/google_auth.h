@@ -2,10 +2,13 @@
 #define GOOGLE_AUTH_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <time.h>
 
+#define GOOGLE_ACCESS_TOKEN_MAX 2048
+
 typedef struct {
-  char access_token[2048];
+  char access_token[GOOGLE_ACCESS_TOKEN_MAX];
   char refresh_token[512];
   time_t expires_at;
 } GoogleTokens;
@@ -21,16 +24,31 @@ typedef enum {
 #define GOOGLE_AUTH_URL_MAX  1024
 #define GOOGLE_AUTH_ERR_MAX  256
 
-extern GoogleTokens    g_googleTokens;
-extern GoogleAuthState g_authState;
-extern char            g_authErrorMsg[GOOGLE_AUTH_ERR_MAX];
 extern char            g_authUrl[GOOGLE_AUTH_URL_MAX];
+// The connection state and the last error message are written by the token
+// refresher and the sync worker as well as the UI, so they are only reached
+// through these (safe from any thread)
+GoogleAuthState GoogleAuth_GetState(void);
+// Copy of the last error message, "" if there is none
+void GoogleAuth_GetError(char *out, size_t size);
+// Move the connect flow along. error replaces the message; NULL keeps it.
+void GoogleAuth_SetState(GoogleAuthState state, const char *error);
+// Loads saved tokens and starts the background refresher, which renews the
+// access token a few minutes before it expires
 void GoogleAuth_Init(void);
+void GoogleAuth_Stop(void);
 void GoogleAuth_BuildAuthUrl(void);
 void GoogleAuth_BuildAuthUrlWithRedirect(const char *redirect_uri);
 bool GoogleAuth_ExchangeCode(const char *code);
+// Blocking; joins a refresh already in flight instead of sending another
 bool GoogleAuth_RefreshAccessToken(void);
+// True if a valid access token is available. Returns at once while the
+// current token is still good; only with no usable token does it wait for a
+// refresh.
 bool GoogleAuth_EnsureValidToken(void);
+// Copy of the current access token (out needs GOOGLE_ACCESS_TOKEN_MAX
+// bytes). Safe from any thread; false if there is none.
+bool GoogleAuth_GetAccessToken(char *out, size_t size);
 void GoogleAuth_Disconnect(void);
 
 #endif
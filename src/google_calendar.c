@@ -1,115 +1,739 @@
 #include "google_calendar.h"
-#include "google_auth.h"
+#include "cJSON.h"
+#include "datetime.h"
 #include "events.h"
+#include "google_auth.h"
+#include "http_client.h"
+#include "refresh_scheduler.h"
 
-#include <curl/curl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
-// ── libcurl write callback ───────────────────────────────────────────────────
-typedef struct {
-  char *data;
-  size_t size;
-} CurlBuffer;
-
-static size_t curl_write_cb(void *ptr, size_t size, size_t nmemb, void *userdata) {
-  size_t total = size * nmemb;
-  CurlBuffer *buf = (CurlBuffer *)userdata;
-  char *tmp = realloc(buf->data, buf->size + total + 1);
-  if (!tmp) return 0;
-  buf->data = tmp;
-  memcpy(buf->data + buf->size, ptr, total);
-  buf->size += total;
-  buf->data[buf->size] = '\0';
-  return total;
-}
-
-// Compute Monday 00:00 UTC and next Monday 00:00 UTC for the current week
-static void get_week_bounds(char *timeMin, size_t minSize, char *timeMax, size_t maxSize) {
-  time_t now = time(NULL);
-  struct tm lt = *localtime(&now);
-
-  // Rewind to Monday
-  int days_since_monday = (lt.tm_wday + 6) % 7;
-  lt.tm_mday -= days_since_monday;
-  lt.tm_hour = 0;
-  lt.tm_min = 0;
-  lt.tm_sec = 0;
-  mktime(&lt);
-
-  // Monday start in RFC3339 UTC
-  struct tm utc_start = lt;
-  // Convert local Monday 00:00 to UTC by using gmtime of the mktime result
-  time_t monday_local = mktime(&lt);
-  struct tm monday_utc = *gmtime(&monday_local);
-  strftime(timeMin, minSize, "%Y-%m-%dT%H:%M:%SZ", &monday_utc);
-
-  // Next Monday
+// Local midnight at the start of weekStart (a Monday day number) and seven
+// days later, as RFC3339 UTC
+static void get_week_bounds(int weekStart, char *timeMin, size_t minSize,
+                            char *timeMax, size_t maxSize) {
+  int year, mon, mday;
+  DateTime_CivilFromDays(weekStart, &year, &mon, &mday);
+  struct tm lt = {0};
+  lt.tm_year = year - 1900;
+  lt.tm_mon = mon - 1;
+  lt.tm_mday = mday;
+  lt.tm_isdst = -1; // Let mktime work out DST for that date
+
+  // Runs on the sync worker; avoid the shared gmtime buffer
+  time_t monday = mktime(&lt);
+  struct tm utc;
+  gmtime_r(&monday, &utc);
+  strftime(timeMin, minSize, "%Y-%m-%dT%H:%M:%SZ", &utc);
+
   lt.tm_mday += 7;
-  time_t next_monday_local = mktime(&lt);
-  struct tm next_monday_utc = *gmtime(&next_monday_local);
-  strftime(timeMax, maxSize, "%Y-%m-%dT%H:%M:%SZ", &next_monday_utc);
+  lt.tm_isdst = -1;
+  time_t nextMonday = mktime(&lt);
+  gmtime_r(&nextMonday, &utc);
+  strftime(timeMax, maxSize, "%Y-%m-%dT%H:%M:%SZ", &utc);
+}
+
+// ── Incremental sync state ───────────────────────────────────────────────────
+// Sync token from each calendar's last complete response per week. A token
+// only covers the week window it was issued for: a delta from it reports
+// changes, it never backfills the events of a different week.
+static GoogleSyncState *s_syncStates = NULL;
+static int s_syncStateCount = 0;
+static int s_syncStateCapacity = 0;
+static uint32_t s_tick = 0; // Bumped per fetch; stamps GoogleSyncState.lastUsed
 
-  (void)utc_start;
+// Make room for `extra` more states, so pointers from sync_state stay valid
+// across that many additions
+static bool reserve_states(int extra) {
+  if (s_syncStateCount + extra <= s_syncStateCapacity) return true;
+  int cap = s_syncStateCapacity ? s_syncStateCapacity : 64;
+  while (cap < s_syncStateCount + extra) cap *= 2;
+  GoogleSyncState *states =
+      realloc(s_syncStates, sizeof(GoogleSyncState) * (size_t)cap);
+  if (!states) return false;
+  s_syncStates = states;
+  s_syncStateCapacity = cap;
+  return true;
 }
 
-void GoogleCalendar_FetchEvents(const char *calendarId, int calIndex) {
-  if (!GoogleAuth_EnsureValidToken()) return;
+// Pointers are only good until the table grows (see reserve_states)
+static GoogleSyncState *sync_state(const char *calendarId, int weekStart) {
+  for (int i = 0; i < s_syncStateCount; i++) {
+    if (s_syncStates[i].weekStart == weekStart &&
+        strcmp(s_syncStates[i].calendarId, calendarId) == 0)
+      return &s_syncStates[i];
+  }
+  if (!reserve_states(1)) return NULL;
+  GoogleSyncState *st = &s_syncStates[s_syncStateCount++];
+  memset(st, 0, sizeof(*st));
+  strncpy(st->calendarId, calendarId, CAL_CALID_LEN - 1);
+  st->weekStart = weekStart;
+  return st;
+}
+
+void GoogleCalendar_ResetSync(void) {
+  s_syncStateCount = 0;
+}
 
-  CURL *curl = curl_easy_init();
-  if (!curl) return;
+void GoogleCalendar_ResetCalendar(const char *calendarId) {
+  int kept = 0;
+  for (int i = 0; i < s_syncStateCount; i++) {
+    if (strcmp(s_syncStates[i].calendarId, calendarId) != 0)
+      s_syncStates[kept++] = s_syncStates[i];
+  }
+  s_syncStateCount = kept;
+}
 
-  char timeMin[64], timeMax[64];
-  get_week_bounds(timeMin, sizeof(timeMin), timeMax, sizeof(timeMax));
-  fprintf(stderr, "Fetching events: %s to %s\n", timeMin, timeMax);
+int GoogleCalendar_SyncStateCount(void) {
+  return s_syncStateCount;
+}
 
-  // URL-encode the calendar ID (handles @ in email addresses)
-  char *escapedId = curl_easy_escape(curl, calendarId, 0);
-  if (!escapedId) {
-    curl_easy_cleanup(curl);
-    return;
+int GoogleCalendar_GetSyncStates(GoogleSyncState *out, int max) {
+  int n = s_syncStateCount < max ? s_syncStateCount : max;
+  memcpy(out, s_syncStates, sizeof(GoogleSyncState) * (size_t)n);
+  return n;
+}
+
+void GoogleCalendar_RestoreSyncState(const GoogleSyncState *saved) {
+  GoogleSyncState *st = sync_state(saved->calendarId, saved->weekStart);
+  if (st) *st = *saved;
+  if (saved->lastUsed > s_tick) s_tick = saved->lastUsed;
+}
+
+// ── Week cache eviction ──────────────────────────────────────────────────────
+typedef struct {
+  int week;
+  uint32_t lastUsed;
+  size_t bytes;
+} CachedWeek;
+
+static size_t event_bytes(const EventStore *store, int i) {
+  const CalEventDetail *d = &store->details[i];
+  return sizeof(CalEvent) + sizeof(CalEventDetail) +
+         (size_t)store->items[i].summaryLength + strlen(d->description) +
+         strlen(d->location) + strlen(d->id);
+}
+
+static bool is_requested(int week, const int *weekStarts, int weekCount) {
+  for (int i = 0; i < weekCount; i++) {
+    if (weekStarts[i] == week) return true;
+  }
+  return false;
+}
+
+void GoogleCalendar_EvictWeeks(EventStore *store, const int *keepWeeks,
+                               int keepCount) {
+  CachedWeek *weeks =
+      malloc(sizeof(CachedWeek) * (size_t)(s_syncStateCount + 1));
+  if (!weeks) return;
+  int n = 0;
+  for (int i = 0; i < s_syncStateCount; i++) {
+    const GoogleSyncState *st = &s_syncStates[i];
+    int w = 0;
+    while (w < n && weeks[w].week != st->weekStart) w++;
+    if (w == n) weeks[n++] = (CachedWeek){st->weekStart, 0, 0};
+    if (st->lastUsed > weeks[w].lastUsed) weeks[w].lastUsed = st->lastUsed;
+  }
+
+  size_t total = 0;
+  for (int i = 0; i < store->count; i++) {
+    int window = store->items[i].window;
+    if (window == CAL_WINDOW_ALL) continue;
+    size_t bytes = event_bytes(store, i);
+    total += bytes;
+    for (int w = 0; w < n; w++) {
+      if (weeks[w].week == window) {
+        weeks[w].bytes += bytes;
+        break;
+      }
+    }
+  }
+
+  while (n > GCAL_MAX_WEEKS || total > GCAL_WEEK_CACHE_BYTES) {
+    int oldest = -1;
+    for (int w = 0; w < n; w++) {
+      if (is_requested(weeks[w].week, keepWeeks, keepCount)) continue;
+      if (oldest < 0 || weeks[w].lastUsed < weeks[oldest].lastUsed)
+        oldest = w;
+    }
+    if (oldest < 0) break; // Only the requested weeks are left
+
+    int week = weeks[oldest].week;
+    fprintf(stderr, "Evicting cached week %d (%zu bytes)\n", week,
+            weeks[oldest].bytes);
+    EventStore_RemoveWindow(store, week);
+    int kept = 0;
+    for (int i = 0; i < s_syncStateCount; i++) {
+      if (s_syncStates[i].weekStart != week)
+        s_syncStates[kept++] = s_syncStates[i];
+    }
+    s_syncStateCount = kept;
+    total -= weeks[oldest].bytes;
+    weeks[oldest] = weeks[--n];
+  }
+  free(weeks);
+}
+
+// ── Paged requests ───────────────────────────────────────────────────────────
+// A calendar's events come back in pages chained by nextPageToken. Google
+// sends the token ahead of the items, so a page's successor is requested as
+// soon as the token shows up in the partial body; while it is in flight the
+// current page finishes downloading and is parsed. At most two pages per
+// calendar are outstanding, and pages are applied to the store in order.
+typedef struct {
+  CURL *curl; // NULL = slot free
+  struct curl_slist *headers;
+  HttpBuffer response;
+  int page;
+  bool done; // Transfer finished, waiting its turn to be applied
+  CURLcode result;
+  bool nextIssued;
+  bool tokenKnown;
+  char pageToken[CAL_SYNC_TOKEN_LEN]; // Token of the page after this one
+  uint64_t urlHash;
+  char etag[HTTP_ETAG_LEN]; // From the response headers
+} PageRequest;
+
+typedef struct {
+  const char *calendarId;
+  const char *timeMin, *timeMax;
+  const char *fields; // URL-encoded events_fields_mask
+  const char *accessToken;
+  int calIndex;
+  int week;
+  GoogleSyncState *state; // NULL if the state table is full
+  bool delta;       // Requests carry state->syncToken
+  bool active;
+  bool begun;       // Not held back by the refresh scheduler
+  RefreshOutcome outcome;
+  long retryAfter;  // Seconds the server asked us to wait, 0 if it didn't
+  int nextApply;    // Page number to apply next
+  PageRequest req[2]; // Page p lives in req[p % 2]
+} CalendarFetch;
+
+// FNV-1a; identifies the request an ETag was issued for
+static uint64_t url_hash(const char *url) {
+  uint64_t h = 14695981039346656037ull;
+  for (; *url; url++) {
+    h ^= (unsigned char)*url;
+    h *= 1099511628211ull;
   }
+  return h;
+}
+
+static void request_release(CURLM *multi, PageRequest *r) {
+  if (!r->curl) return;
+  curl_multi_remove_handle(multi, r->curl);
+  HttpClient_Release(r->curl);
+  curl_slist_free_all(r->headers);
+  free(r->response.data);
+  memset(r, 0, sizeof(*r));
+}
+
+// Start the request for page `page` of the calendar, continuing from
+// pageToken (NULL for the first page)
+static bool request_start(CURLM *multi, CalendarFetch *c, int page,
+                          const char *pageToken) {
+  PageRequest *r = &c->req[page % 2];
+  memset(r, 0, sizeof(*r));
+  r->page = page;
+  r->curl = HttpClient_Acquire();
+  if (!r->curl) return false;
+
+  // URL-encode the calendar ID (handles @ in email addresses) and tokens
+  char *escapedId = curl_easy_escape(r->curl, c->calendarId, 0);
+  char *escapedSync =
+      c->delta ? curl_easy_escape(r->curl, c->state->syncToken, 0) : NULL;
+  char *escapedPage = pageToken ? curl_easy_escape(r->curl, pageToken, 0) : NULL;
+  bool ok = escapedId && (!c->delta || escapedSync) &&
+            (!pageToken || escapedPage);
 
-  char url[1024];
-  snprintf(url, sizeof(url),
-    "https://www.googleapis.com/calendar/v3/calendars/%s/events"
-    "?timeMin=%s&timeMax=%s&singleEvents=true&orderBy=startTime&maxResults=250",
-    escapedId, timeMin, timeMax);
+  // syncToken can't be combined with timeMin/timeMax/orderBy; the full
+  // request drops orderBy too so its token stays usable
+  char url[2048];
+  if (ok && c->delta) {
+    snprintf(url, sizeof(url),
+      "https://www.googleapis.com/calendar/v3/calendars/%s/events"
+      "?syncToken=%s&singleEvents=true&maxResults=250&fields=%s%s%s",
+      escapedId, escapedSync, c->fields, escapedPage ? "&pageToken=" : "",
+      escapedPage ? escapedPage : "");
+  } else if (ok) {
+    snprintf(url, sizeof(url),
+      "https://www.googleapis.com/calendar/v3/calendars/%s/events"
+      "?timeMin=%s&timeMax=%s&singleEvents=true&maxResults=250&fields=%s%s%s",
+      escapedId, c->timeMin, c->timeMax, c->fields,
+      escapedPage ? "&pageToken=" : "",
+      escapedPage ? escapedPage : "");
+  }
   curl_free(escapedId);
+  curl_free(escapedSync);
+  curl_free(escapedPage);
+  if (!ok) {
+    HttpClient_Release(r->curl);
+    r->curl = NULL;
+    return false;
+  }
 
   // Authorization header
   char authHeader[2200];
-  snprintf(authHeader, sizeof(authHeader), "Authorization: Bearer %s", g_googleTokens.access_token);
-  struct curl_slist *headers = NULL;
-  headers = curl_slist_append(headers, authHeader);
+  snprintf(authHeader, sizeof(authHeader), "Authorization: Bearer %s",
+           c->accessToken);
+  r->headers = curl_slist_append(NULL, authHeader);
+  // Revalidate the first page against what this URL returned last time
+  r->urlHash = url_hash(url);
+  const GoogleSyncState *st = c->state;
+  if (page == 0 && st && st->etag[0] && st->etagUrl == r->urlHash) {
+    char ifNoneMatch[GCAL_ETAG_LEN + 32];
+    snprintf(ifNoneMatch, sizeof(ifNoneMatch), "If-None-Match: %s", st->etag);
+    r->headers = curl_slist_append(r->headers, ifNoneMatch);
+  }
 
-  CurlBuffer response = {0};
+  curl_easy_setopt(r->curl, CURLOPT_URL, url);
+  curl_easy_setopt(r->curl, CURLOPT_HTTPHEADER, r->headers);
+  curl_easy_setopt(r->curl, CURLOPT_WRITEDATA, &r->response);
+  curl_easy_setopt(r->curl, CURLOPT_HEADERFUNCTION, HttpClient_EtagCb);
+  curl_easy_setopt(r->curl, CURLOPT_HEADERDATA, r->etag);
+  curl_easy_setopt(r->curl, CURLOPT_PRIVATE, r);
+  // Prefer HTTP/2, and wait for an existing connection to multiplex on
+  // rather than opening one per calendar
+  curl_easy_setopt(r->curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+  curl_easy_setopt(r->curl, CURLOPT_PIPEWAIT, 1L);
 
-  curl_easy_setopt(curl, CURLOPT_URL, url);
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_cb);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+  if (curl_multi_add_handle(multi, r->curl) != CURLM_OK) {
+    request_release(multi, r);
+    return false;
+  }
+  return true;
+}
 
-  CURLcode res = curl_easy_perform(curl);
+// Begin (or restart) a calendar week at its first page: a delta against its
+// sync token when it has one, else the full week
+static void calendar_start(CURLM *multi, CalendarFetch *c) {
+  request_release(multi, &c->req[0]);
+  request_release(multi, &c->req[1]);
+  c->delta = c->state && c->state->syncToken[0];
+  c->nextApply = 0;
+  c->active = request_start(multi, c, 0, NULL);
+  if (!c->active) c->outcome = REFRESH_FAILED;
+}
 
-  long http_code = 0;
-  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+// Start fetches[index] unless the scheduler is holding its calendar back or
+// another week of the calendar was already rate limited in this sync
+static void calendar_begin(CURLM *multi, CalendarFetch *fetches, int index,
+                           time_t now) {
+  CalendarFetch *c = &fetches[index];
+  c->begun = RefreshScheduler_MayFetch(c->calendarId, now);
+  for (int i = 0; c->begun && i < index; i++) {
+    if (fetches[i].begun && fetches[i].outcome == REFRESH_RATE_LIMITED &&
+        strcmp(fetches[i].calendarId, c->calendarId) == 0)
+      c->begun = false;
+  }
+  if (c->begun)
+    calendar_start(multi, c);
+  else
+    fprintf(stderr, "Google Calendar %s backing off, skipped\n",
+            c->calendarId);
+}
+
+// Google reports quota errors as 403 with one of these reasons, or as 429
+static bool is_rate_limited(long httpCode, const char *body) {
+  if (httpCode == 429) return true;
+  return httpCode == 403 && body &&
+         (strstr(body, "rateLimitExceeded") ||
+          strstr(body, "userRateLimitExceeded") ||
+          strstr(body, "quotaExceeded"));
+}
 
-  curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
+static void calendar_stop(CURLM *multi, CalendarFetch *c) {
+  request_release(multi, &c->req[0]);
+  request_release(multi, &c->req[1]);
+  c->active = false;
+}
 
-  if (res != CURLE_OK) {
-    fprintf(stderr, "Google Calendar fetch failed: %s\n", curl_easy_strerror(res));
+// Parse the next page in order. Returns false when the calendar is done,
+// failed or was restarted.
+static bool calendar_apply(CURLM *multi, EventStore *store, CalendarFetch *c,
+                           PageRequest *r) {
+  long http_code = 0;
+  curl_easy_getinfo(r->curl, CURLINFO_RESPONSE_CODE, &http_code);
+
+  if (r->result != CURLE_OK) {
+    fprintf(stderr, "Google Calendar fetch failed (%s): %s\n", c->calendarId,
+            curl_easy_strerror(r->result));
   } else {
-    fprintf(stderr, "Google Calendar HTTP %ld, %zu bytes\n", http_code, response.size);
-    if (http_code == 200 && response.data) {
-      load_events_from_json(response.data, calIndex);
-    } else if (response.data) {
-      fprintf(stderr, "Google Calendar error: %.500s\n", response.data);
+    fprintf(stderr, "Google Calendar HTTP %ld, %zu bytes (%s, %s page %d)\n",
+            http_code, r->response.size, c->calendarId,
+            c->delta ? "delta" : "full", r->page + 1);
+  }
+
+  if (r->result == CURLE_OK && http_code == 410 && c->delta) {
+    // Token expired or invalidated by the server
+    fprintf(stderr, "Sync token for %s expired, doing a full sync\n",
+            c->calendarId);
+    c->state->syncToken[0] = '\0';
+    calendar_start(multi, c);
+    return false;
+  }
+  if (r->result == CURLE_OK && http_code == 304 && r->page == 0) {
+    // Same response as last time: its events are already in the store
+    fprintf(stderr, "Google Calendar %s unchanged\n", c->calendarId);
+    calendar_stop(multi, c);
+    return false;
+  }
+  if (r->result != CURLE_OK || http_code != 200 || !r->response.data) {
+    if (r->result == CURLE_OK && r->response.data)
+      fprintf(stderr, "Google Calendar error: %.500s\n", r->response.data);
+    c->outcome = r->result == CURLE_OK &&
+                         is_rate_limited(http_code, r->response.data)
+                     ? REFRESH_RATE_LIMITED
+                     : REFRESH_FAILED;
+    curl_off_t retryAfter = 0;
+    if (curl_easy_getinfo(r->curl, CURLINFO_RETRY_AFTER, &retryAfter) ==
+            CURLE_OK &&
+        retryAfter > 0)
+      c->retryAfter = (long)retryAfter;
+    // Earlier pages are already in; make the next sync start over
+    if (r->page > 0 && c->state) c->state->syncToken[0] = '\0';
+    calendar_stop(multi, c);
+    return false;
+  }
+
+  // The store no longer matches the remembered response
+  if (r->page == 0 && c->state) c->state->etag[0] = '\0';
+  // A full response replaces the calendar's week; a delta patches it
+  if (!c->delta && r->page == 0)
+    EventStore_RemoveCalendarWindow(store, c->calIndex, c->week);
+  EventsResponseInfo info;
+  bool ok = load_events_from_json(store, r->response.data, c->calIndex,
+                                  c->week, c->delta, &info);
+  if (!ok) {
+    if (c->state) c->state->syncToken[0] = '\0';
+    // A delta that failed halfway leaves the calendar in an unknown state
+    if (c->delta) {
+      calendar_start(multi, c);
+    } else {
+      c->outcome = REFRESH_FAILED;
+      calendar_stop(multi, c);
+    }
+    return false;
+  }
+
+  if (!r->tokenKnown) {
+    r->tokenKnown = true;
+    strcpy(r->pageToken, info.nextPageToken);
+  }
+  if (!r->pageToken[0]) {
+    // Last page: it alone carries the token for the next sync
+    if (c->state)
+      snprintf(c->state->syncToken, sizeof(c->state->syncToken), "%s",
+               info.nextSyncToken);
+    // Only a one-page response can be revalidated as a whole
+    if (c->state && r->page == 0 && strlen(r->etag) < GCAL_ETAG_LEN) {
+      strcpy(c->state->etag, r->etag);
+      c->state->etagUrl = r->urlHash;
+    }
+    calendar_stop(multi, c);
+    return false;
+  }
+  if (!r->nextIssued && !request_start(multi, c, r->page + 1, r->pageToken)) {
+    if (c->state) c->state->syncToken[0] = '\0';
+    c->outcome = REFRESH_FAILED;
+    calendar_stop(multi, c);
+    return false;
+  }
+  request_release(multi, r);
+  c->nextApply++;
+  return true;
+}
+
+// Advance one calendar after transfer progress: request successors whose
+// token has arrived and apply finished pages in order
+static void calendar_pump(CURLM *multi, EventStore *store, CalendarFetch *c) {
+  while (c->active) {
+    PageRequest *r = &c->req[c->nextApply % 2];
+    if (r->curl && !r->nextIssued) {
+      if (!r->tokenKnown && r->response.data)
+        r->tokenKnown = events_peek_page_token(
+            r->response.data, r->response.size, r->pageToken,
+            sizeof(r->pageToken));
+      // The successor's slot is free: its previous user was applied
+      if (r->tokenKnown && r->pageToken[0]) {
+        if (!request_start(multi, c, r->page + 1, r->pageToken)) {
+          if (c->state) c->state->syncToken[0] = '\0';
+          c->outcome = REFRESH_FAILED;
+          calendar_stop(multi, c);
+          return;
+        }
+        r->nextIssued = true;
+      }
     }
+    if (!r->curl || !r->done || !calendar_apply(multi, store, c, r))
+      return;
   }
+}
 
-  free(response.data);
+void GoogleCalendar_FetchEvents(EventStore *store, const char *calendarId,
+                                int calIndex, int weekStart) {
+  GoogleFetchTarget target = {calendarId, calIndex, weekStart};
+  GoogleCalendar_FetchAll(store, &target, 1);
+}
+
+void GoogleCalendar_FetchAll(EventStore *store,
+                             const GoogleFetchTarget *targets, int count) {
+  if (count <= 0) return;
+  // One copy of the token for the whole batch; the refresher may replace
+  // the shared one at any time
+  char accessToken[GOOGLE_ACCESS_TOKEN_MAX];
+  if (!GoogleAuth_EnsureValidToken() ||
+      !GoogleAuth_GetAccessToken(accessToken, sizeof(accessToken)))
+    return;
+
+  // Only what the parser reads comes back: no attendees, conference data,
+  // reminders or the like
+  char mask[512];
+  if (events_fields_mask(mask, sizeof(mask)) >= sizeof(mask)) return;
+  char *fields = curl_easy_escape(NULL, mask, 0);
+
+  CalendarFetch *fetches = calloc((size_t)count, sizeof(CalendarFetch));
+  char(*bounds)[2][64] = malloc(sizeof(*bounds) * (size_t)count);
+  CURLM *multi = curl_multi_init();
+  if (!fields || !fetches || !bounds || !multi) {
+    curl_free(fields);
+    free(fetches);
+    free(bounds);
+    if (multi) curl_multi_cleanup(multi);
+    return;
+  }
+  curl_multi_setopt(multi, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX);
+  fprintf(stderr, "Fetching events: %d calendar weeks\n", count);
+
+  // Every state exists before any pointer to one is kept
+  s_tick++;
+  bool haveStates = reserve_states(count);
+  for (int i = 0; i < count; i++) {
+    CalendarFetch *c = &fetches[i];
+    c->calendarId = targets[i].calendarId;
+    c->calIndex = targets[i].calIndex;
+    c->week = targets[i].week;
+    get_week_bounds(c->week, bounds[i][0], sizeof(bounds[i][0]), bounds[i][1],
+                    sizeof(bounds[i][1]));
+    c->timeMin = bounds[i][0];
+    c->timeMax = bounds[i][1];
+    c->fields = fields;
+    c->accessToken = accessToken;
+    c->state = haveStates ? sync_state(c->calendarId, c->week) : NULL;
+    if (c->state) c->state->lastUsed = s_tick;
+  }
+
+  // Drive the transfers together; each page is applied as soon as it and
+  // the pages before it are complete, so the total tracks the slowest
+  // calendar rather than the sum of all round trips. The first targets
+  // start right away, later ones as earlier ones finish.
+  time_t now = time(NULL);
+  int started = 0;
+  while (started < count && started < GCAL_MAX_CONCURRENT)
+    calendar_begin(multi, fetches, started++, now);
+  for (;;) {
+    int running = 0;
+    CURLMcode mc = curl_multi_perform(multi, &running);
+    if (mc != CURLM_OK) {
+      fprintf(stderr, "Google Calendar fetch failed: %s\n",
+              curl_multi_strerror(mc));
+      break;
+    }
+
+    CURLMsg *msg;
+    int pending;
+    while ((msg = curl_multi_info_read(multi, &pending))) {
+      if (msg->msg != CURLMSG_DONE) continue;
+      PageRequest *r = NULL;
+      curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&r);
+      r->done = true;
+      r->result = msg->data.result;
+    }
+
+    int active = 0;
+    for (int i = 0; i < started; i++) {
+      calendar_pump(multi, store, &fetches[i]);
+      active += fetches[i].active;
+    }
+    // Hand freed slots to the next targets in line
+    while (active < GCAL_MAX_CONCURRENT && started < count) {
+      calendar_begin(multi, fetches, started++, time(NULL));
+      active += fetches[started - 1].active;
+    }
+    if (active == 0) break;
+
+    mc = curl_multi_poll(multi, NULL, 0, 1000, NULL);
+    if (mc != CURLM_OK) {
+      fprintf(stderr, "Google Calendar fetch failed: %s\n",
+              curl_multi_strerror(mc));
+      break;
+    }
+  }
+
+  // Anything still attached was cut short by a multi error
+  now = time(NULL);
+  for (int i = 0; i < started; i++) {
+    CalendarFetch *c = &fetches[i];
+    if (c->active) c->outcome = REFRESH_FAILED;
+    if (c->begun)
+      RefreshScheduler_Report(c->calendarId, c->outcome, c->retryAfter, now);
+    calendar_stop(multi, c);
+  }
+  curl_multi_cleanup(multi);
+  curl_free(fields);
+  free(fetches);
+  free(bounds);
+}
+
+// ── Calendar list ────────────────────────────────────────────────────────────
+// Copy at most size - 1 bytes without cutting a UTF-8 sequence in half
+static void copy_name(char *dst, size_t size, const char *src) {
+  size_t len = strlen(src);
+  if (len >= size) {
+    len = size - 1;
+    while (len > 0 && ((unsigned char)src[len] & 0xC0) == 0x80) len--;
+  }
+  memcpy(dst, src, len);
+  dst[len] = '\0';
+}
+
+// "#rrggbb" -> cal color; false leaves it untouched
+static bool parse_color(const char *hex, LinkedCalendar *cal) {
+  unsigned r, g, b;
+  if (!hex || sscanf(hex, "#%2x%2x%2x", &r, &g, &b) != 3) return false;
+  cal->colorR = (uint8_t)r;
+  cal->colorG = (uint8_t)g;
+  cal->colorB = (uint8_t)b;
+  cal->colorA = 255;
+  return true;
+}
+
+// Append the calendars of one calendarList page. Returns false on malformed
+// input or a page token too long to follow (the list would come back cut
+// short); *pageToken gets the next page's token ("" on the last page).
+static bool add_calendar_page(const char *json, LinkedCalendar **list,
+                              int *count, int *capacity, char *pageToken,
+                              size_t tokenSize) {
+  cJSON *root = cJSON_Parse(json);
+  if (!root) return false;
+  const cJSON *items = cJSON_GetObjectItemCaseSensitive(root, "items");
+  const cJSON *next = cJSON_GetObjectItemCaseSensitive(root, "nextPageToken");
+  pageToken[0] = '\0';
+  if (cJSON_IsString(next)) {
+    size_t len = strlen(next->valuestring);
+    if (len >= tokenSize) {
+      fprintf(stderr, "Calendar list page token too long (%zu bytes)\n", len);
+      cJSON_Delete(root);
+      return false;
+    }
+    memcpy(pageToken, next->valuestring, len + 1);
+  }
+
+  const cJSON *item;
+  cJSON_ArrayForEach(item, items) {
+    const cJSON *id = cJSON_GetObjectItemCaseSensitive(item, "id");
+    const cJSON *summary = cJSON_GetObjectItemCaseSensitive(item, "summary");
+    const cJSON *override =
+        cJSON_GetObjectItemCaseSensitive(item, "summaryOverride");
+    const cJSON *color =
+        cJSON_GetObjectItemCaseSensitive(item, "backgroundColor");
+    bool primary =
+        cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(item, "primary"));
+    bool selected =
+        cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(item, "selected"));
+    // Ids can't be truncated; one that doesn't fit can't be fetched
+    if (!cJSON_IsString(id) || strlen(id->valuestring) >= CAL_CALID_LEN)
+      continue;
+
+    if (*count == *capacity) {
+      int cap = *capacity ? *capacity * 2 : 16;
+      LinkedCalendar *grown =
+          realloc(*list, sizeof(LinkedCalendar) * (size_t)cap);
+      if (!grown) break;
+      *list = grown;
+      *capacity = cap;
+    }
+    LinkedCalendar *cal = &(*list)[*count];
+    memset(cal, 0, sizeof(*cal));
+    cal->source = CAL_SOURCE_GOOGLE;
+    const char *name = cJSON_IsString(override) ? override->valuestring
+                       : cJSON_IsString(summary) ? summary->valuestring
+                                                 : id->valuestring;
+    copy_name(cal->name, CAL_NAME_LEN, name);
+    // Keep the id the primary calendar was linked under before discovery,
+    // so its cached events and sync tokens stay valid
+    strcpy(cal->calendarId, primary ? "primary" : id->valuestring);
+    if (!parse_color(cJSON_IsString(color) ? color->valuestring : NULL, cal)) {
+      cal->colorR = 66; cal->colorG = 133; cal->colorB = 244; cal->colorA = 255;
+    }
+    cal->visible = selected || primary;
+
+    if (primary && *count > 0) {
+      LinkedCalendar first = *cal;
+      memmove(*list + 1, *list, sizeof(LinkedCalendar) * (size_t)*count);
+      (*list)[0] = first;
+    }
+    (*count)++;
+  }
+  cJSON_Delete(root);
+  return true;
+}
+
+bool GoogleCalendar_ListCalendars(LinkedCalendar **out, int *count) {
+  *out = NULL;
+  *count = 0;
+  char accessToken[GOOGLE_ACCESS_TOKEN_MAX];
+  if (!GoogleAuth_EnsureValidToken() ||
+      !GoogleAuth_GetAccessToken(accessToken, sizeof(accessToken)))
+    return false;
+
+  LinkedCalendar *list = NULL;
+  int n = 0, capacity = 0;
+  char pageToken[CAL_SYNC_TOKEN_LEN] = "";
+  bool ok = true;
+  do {
+    char url[1024];
+    int len = snprintf(url, sizeof(url),
+        "https://www.googleapis.com/calendar/v3/users/me/calendarList"
+        "?minAccessRole=reader&maxResults=250");
+    if (pageToken[0]) {
+      char *escaped = curl_easy_escape(NULL, pageToken, 0);
+      if (!escaped) {
+        ok = false;
+        break;
+      }
+      snprintf(url + len, sizeof(url) - (size_t)len, "&pageToken=%s", escaped);
+      curl_free(escaped);
+    }
+
+    HttpBuffer response = {0};
+    long httpCode = 0;
+    CURLcode res = HttpClient_Get(url, accessToken, &response, &httpCode);
+    ok = res == CURLE_OK && httpCode == 200 && response.data &&
+         add_calendar_page(response.data, &list, &n, &capacity, pageToken,
+                           sizeof(pageToken));
+    if (!ok) {
+      if (res != CURLE_OK)
+        fprintf(stderr, "Google calendar list failed: %s\n",
+                curl_easy_strerror(res));
+      else
+        fprintf(stderr, "Google calendar list HTTP %ld: %.500s\n", httpCode,
+                response.data ? response.data : "");
+    }
+    free(response.data);
+  } while (ok && pageToken[0]);
+
+  if (!ok) {
+    free(list);
+    return false;
+  }
+  fprintf(stderr, "Found %d Google calendars\n", n);
+  *out = list;
+  *count = n;
+  return true;
 }
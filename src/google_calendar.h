@@ -1,6 +1,70 @@
 #ifndef GOOGLE_CALENDAR_H
 #define GOOGLE_CALENDAR_H
 
-void GoogleCalendar_FetchEvents(const char *calendarId, int calIndex);
+#include "events.h"
+
+// Weeks kept synced at most; beyond that (or past GCAL_WEEK_CACHE_BYTES of
+// events) the least recently viewed weeks are dropped by EvictWeeks
+#define GCAL_MAX_WEEKS 12
+#define GCAL_WEEK_CACHE_BYTES (2u << 20)
+// Sync states one calendar can have: every cached week plus a prefetch
+#define GCAL_STATES_PER_CALENDAR (GCAL_MAX_WEEKS + CAL_PREFETCH_WEEKS)
+// Calendar weeks downloading at once (each has up to two requests in
+// flight); the rest wait their turn
+#define GCAL_MAX_CONCURRENT 5
+
+// Longest events-response ETag remembered per sync state
+#define GCAL_ETAG_LEN 128
+
+// Sync token from the last complete response for one calendar and week
+// window (Monday's day number). lastUsed orders weeks for eviction.
+//
+// etag validates the last single-page response, whose request URL hashes to
+// etagUrl: the next request for that same URL is sent with If-None-Match,
+// and a 304 leaves the events it produced in place.
+typedef struct {
+  char calendarId[CAL_CALID_LEN];
+  int32_t weekStart;
+  uint32_t lastUsed;
+  char syncToken[CAL_SYNC_TOKEN_LEN];
+  uint64_t etagUrl;
+  char etag[GCAL_ETAG_LEN];
+} GoogleSyncState;
+
+// One calendar week to fetch; calIndex tags its events
+typedef struct {
+  const char *calendarId;
+  int calIndex;
+  int week;
+} GoogleFetchTarget;
+
+// Bring calendarId's events for the week starting on day weekStart up to
+// date, incrementally when a sync token from an earlier call allows it.
+// Blocks on the network.
+void GoogleCalendar_FetchEvents(EventStore *store, const char *calendarId,
+                                int calIndex, int weekStart);
+// Same for many calendar weeks, over shared (HTTP/2 multiplexed where
+// available) connections. Targets start in array order, at most
+// GCAL_MAX_CONCURRENT at a time, so callers put what is on screen first.
+void GoogleCalendar_FetchAll(EventStore *store,
+                             const GoogleFetchTarget *targets, int count);
+// Drop the least recently fetched weeks, other than keepWeeks, until the
+// cache is back within GCAL_MAX_WEEKS and GCAL_WEEK_CACHE_BYTES
+void GoogleCalendar_EvictWeeks(EventStore *store, const int *keepWeeks,
+                               int keepCount);
+
+// The user's calendarList as linked calendars, primary first (with id
+// "primary") and visible if selected in Google Calendar. *out is malloc'd;
+// false if the list couldn't be fetched.
+bool GoogleCalendar_ListCalendars(LinkedCalendar **out, int *count);
+
+// Forget all sync tokens; the next fetch of every calendar is a full one
+void GoogleCalendar_ResetSync(void);
+// Same for one calendar, every week
+void GoogleCalendar_ResetCalendar(const char *calendarId);
+// Copy out / put back sync tokens so they survive restarts
+int  GoogleCalendar_SyncStateCount(void);
+int  GoogleCalendar_GetSyncStates(GoogleSyncState *out, int max);
+void GoogleCalendar_RestoreSyncState(const GoogleSyncState *saved);
 
 #endif
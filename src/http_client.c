@@ -0,0 +1,194 @@
+#include "http_client.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// One per concurrent calendar fetch plus headroom for token requests
+#define HTTP_POOL_SIZE 12
+
+static CURLSH *s_share = NULL;
+static pthread_mutex_t s_shareLocks[CURL_LOCK_DATA_LAST];
+
+static pthread_mutex_t s_poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static CURL *s_pool[HTTP_POOL_SIZE];
+static int s_poolCount = 0;
+
+// ── Share object locking ─────────────────────────────────────────────────────
+static void share_lock(CURL *curl, curl_lock_data data,
+                       curl_lock_access access, void *userptr) {
+  (void)curl;
+  (void)access;
+  (void)userptr;
+  pthread_mutex_lock(&s_shareLocks[data]);
+}
+
+static void share_unlock(CURL *curl, curl_lock_data data, void *userptr) {
+  (void)curl;
+  (void)userptr;
+  pthread_mutex_unlock(&s_shareLocks[data]);
+}
+
+bool HttpClient_Init(void) {
+  if (s_share)
+    return true;
+  for (int i = 0; i < CURL_LOCK_DATA_LAST; i++)
+    pthread_mutex_init(&s_shareLocks[i], NULL);
+
+  s_share = curl_share_init();
+  if (!s_share) {
+    fprintf(stderr, "curl_share_init failed, connections won't be shared\n");
+    return false;
+  }
+  curl_share_setopt(s_share, CURLSHOPT_LOCKFUNC, share_lock);
+  curl_share_setopt(s_share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+  curl_share_setopt(s_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(s_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  // Not CURL_LOCK_DATA_CONNECT: libcurl can't share a connection cache
+  // between threads running transfers at the same time
+  return true;
+}
+
+void HttpClient_Cleanup(void) {
+  pthread_mutex_lock(&s_poolMutex);
+  for (int i = 0; i < s_poolCount; i++)
+    curl_easy_cleanup(s_pool[i]);
+  s_poolCount = 0;
+  pthread_mutex_unlock(&s_poolMutex);
+
+  // Only valid once no handle uses it any more
+  if (s_share) {
+    curl_share_cleanup(s_share);
+    s_share = NULL;
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++)
+      pthread_mutex_destroy(&s_shareLocks[i]);
+  }
+}
+
+// ── Handle pool ──────────────────────────────────────────────────────────────
+CURL *HttpClient_Acquire(void) {
+  CURL *curl = NULL;
+  pthread_mutex_lock(&s_poolMutex);
+  if (s_poolCount > 0)
+    curl = s_pool[--s_poolCount];
+  pthread_mutex_unlock(&s_poolMutex);
+
+  if (!curl)
+    curl = curl_easy_init();
+  if (!curl)
+    return NULL;
+
+  if (s_share)
+    curl_easy_setopt(curl, CURLOPT_SHARE, s_share);
+  // "" offers every encoding this libcurl can decode (gzip, br, ...)
+  curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  // Used off the main thread: no SIGALRM-based DNS timeouts
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 15L);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, 60L);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, HttpClient_WriteCb);
+  return curl;
+}
+
+void HttpClient_Release(CURL *curl) {
+  if (!curl)
+    return;
+  // Reset drops per-request options but keeps the handle's live
+  // connections and caches
+  curl_easy_reset(curl);
+
+  pthread_mutex_lock(&s_poolMutex);
+  if (s_poolCount < HTTP_POOL_SIZE) {
+    s_pool[s_poolCount++] = curl;
+    curl = NULL;
+  }
+  pthread_mutex_unlock(&s_poolMutex);
+
+  if (curl)
+    curl_easy_cleanup(curl);
+}
+
+// ── Requests ─────────────────────────────────────────────────────────────────
+size_t HttpClient_WriteCb(void *ptr, size_t size, size_t nmemb,
+                          void *userdata) {
+  size_t total = size * nmemb;
+  HttpBuffer *buf = (HttpBuffer *)userdata;
+  char *tmp = realloc(buf->data, buf->size + total + 1);
+  if (!tmp)
+    return 0;
+  buf->data = tmp;
+  memcpy(buf->data + buf->size, ptr, total);
+  buf->size += total;
+  buf->data[buf->size] = '\0';
+  return total;
+}
+
+size_t HttpClient_EtagCb(char *line, size_t size, size_t nitems,
+                         void *userdata) {
+  size_t total = size * nitems;
+  char *etag = (char *)userdata;
+  // A new status line starts another response (redirect, 100-continue)
+  if (total >= 5 && strncmp(line, "HTTP/", 5) == 0)
+    etag[0] = '\0';
+  if (total <= 5 || strncasecmp(line, "etag:", 5) != 0)
+    return total;
+
+  size_t start = 5, end = total;
+  while (start < end && (line[start] == ' ' || line[start] == '\t'))
+    start++;
+  while (end > start && (line[end - 1] == '\r' || line[end - 1] == '\n' ||
+                         line[end - 1] == ' '))
+    end--;
+  if (end - start < HTTP_ETAG_LEN) {
+    memcpy(etag, line + start, end - start);
+    etag[end - start] = '\0';
+  }
+  return total;
+}
+
+CURLcode HttpClient_Post(const char *url, const char *fields, HttpBuffer *out,
+                         long *httpCode) {
+  CURL *curl = HttpClient_Acquire();
+  if (!curl)
+    return CURLE_FAILED_INIT;
+
+  curl_easy_setopt(curl, CURLOPT_URL, url);
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, fields);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, out);
+
+  CURLcode res = curl_easy_perform(curl);
+  if (httpCode) {
+    *httpCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, httpCode);
+  }
+  HttpClient_Release(curl);
+  return res;
+}
+
+CURLcode HttpClient_Get(const char *url, const char *bearerToken,
+                        HttpBuffer *out, long *httpCode) {
+  CURL *curl = HttpClient_Acquire();
+  if (!curl)
+    return CURLE_FAILED_INIT;
+
+  char authHeader[2200];
+  snprintf(authHeader, sizeof(authHeader), "Authorization: Bearer %s",
+           bearerToken);
+  struct curl_slist *headers = curl_slist_append(NULL, authHeader);
+
+  curl_easy_setopt(curl, CURLOPT_URL, url);
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, out);
+
+  CURLcode res = curl_easy_perform(curl);
+  if (httpCode) {
+    *httpCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, httpCode);
+  }
+  HttpClient_Release(curl);
+  curl_slist_free_all(headers);
+  return res;
+}
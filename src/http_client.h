@@ -0,0 +1,55 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <curl/curl.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Shared libcurl plumbing for every Google API call.
+//
+// Easy handles are pooled instead of created per request, and all of them
+// attach to one CURLSH share object holding the DNS cache and the TLS
+// session cache, and nothing else. Connections are not shared: each multi
+// handle (the sync worker's) and each pooled easy handle keeps its own, so
+// keep-alive and HTTP/2 reuse stay within one thread, while a new connection
+// from any thread at least skips DNS and resumes the TLS session.
+// Responses are requested compressed.
+//
+// Safe to use from the render thread, the OAuth server, the token refresher
+// and the sync worker at the same time.
+
+// Response body accumulator, always NUL-terminated once data arrives
+typedef struct {
+  char *data;
+  size_t size;
+} HttpBuffer;
+
+// Longest ETag kept, quotes and W/ prefix included
+#define HTTP_ETAG_LEN 128
+
+// Call once after curl_global_init / before curl_global_cleanup
+bool HttpClient_Init(void);
+void HttpClient_Cleanup(void);
+
+// Borrow a handle preset with the share object, keep-alive and
+// Accept-Encoding; the caller only sets the request itself. NULL on failure.
+CURL *HttpClient_Acquire(void);
+// Return a handle to the pool (resets any per-request options)
+void HttpClient_Release(CURL *curl);
+
+// CURLOPT_WRITEFUNCTION appending to the HttpBuffer passed as WRITEDATA
+size_t HttpClient_WriteCb(void *ptr, size_t size, size_t nmemb,
+                          void *userdata);
+// CURLOPT_HEADERFUNCTION copying the response's ETag into the
+// char[HTTP_ETAG_LEN] passed as HEADERDATA ("" if absent or too long)
+size_t HttpClient_EtagCb(char *line, size_t size, size_t nitems,
+                         void *userdata);
+
+// Blocking form POST. out must be zeroed; the caller frees out->data.
+CURLcode HttpClient_Post(const char *url, const char *fields, HttpBuffer *out,
+                         long *httpCode);
+// Blocking GET with an OAuth bearer token. Same buffer rules as Post.
+CURLcode HttpClient_Get(const char *url, const char *bearerToken,
+                        HttpBuffer *out, long *httpCode);
+
+#endif
@@ -0,0 +1,225 @@
+#include "json_reader.h"
+
+#include <string.h>
+
+void JsonReader_Init(JsonReader *r, const char *json, size_t length) {
+  r->pos = json;
+  r->end = json + length;
+}
+
+static bool is_skippable(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' ||
+         c == ':';
+}
+
+static JsonTokenType scan_literal(JsonReader *r, JsonToken *tok,
+                                  const char *word, JsonTokenType type) {
+  size_t n = strlen(word);
+  if ((size_t)(r->end - r->pos) < n || memcmp(r->pos, word, n) != 0)
+    return tok->type = JSON_TOK_ERROR;
+  tok->start = r->pos;
+  tok->length = n;
+  r->pos += n;
+  return tok->type = type;
+}
+
+JsonTokenType JsonReader_Next(JsonReader *r, JsonToken *tok) {
+  while (r->pos < r->end && is_skippable(*r->pos))
+    r->pos++;
+
+  tok->hasEscapes = false;
+  tok->length = 0;
+  tok->start = r->pos;
+  if (r->pos >= r->end || *r->pos == '\0')
+    return tok->type = JSON_TOK_END;
+
+  char c = *r->pos;
+  switch (c) {
+  case '{':
+    r->pos++;
+    return tok->type = JSON_TOK_OBJECT_BEGIN;
+  case '}':
+    r->pos++;
+    return tok->type = JSON_TOK_OBJECT_END;
+  case '[':
+    r->pos++;
+    return tok->type = JSON_TOK_ARRAY_BEGIN;
+  case ']':
+    r->pos++;
+    return tok->type = JSON_TOK_ARRAY_END;
+  case '"': {
+    const char *p = ++r->pos;
+    while (p < r->end && *p != '"') {
+      if (*p == '\\') {
+        tok->hasEscapes = true;
+        p++; // The escaped character can't close the string
+      }
+      p++;
+    }
+    if (p >= r->end)
+      return tok->type = JSON_TOK_ERROR;
+    tok->start = r->pos;
+    tok->length = (size_t)(p - r->pos);
+    r->pos = p + 1;
+    return tok->type = JSON_TOK_STRING;
+  }
+  case 't':
+    return scan_literal(r, tok, "true", JSON_TOK_TRUE);
+  case 'f':
+    return scan_literal(r, tok, "false", JSON_TOK_FALSE);
+  case 'n':
+    return scan_literal(r, tok, "null", JSON_TOK_NULL);
+  default:
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      const char *p = r->pos;
+      while (p < r->end && (*p == '-' || *p == '+' || *p == '.' ||
+                            *p == 'e' || *p == 'E' || (*p >= '0' && *p <= '9')))
+        p++;
+      tok->length = (size_t)(p - r->pos);
+      r->pos = p;
+      return tok->type = JSON_TOK_NUMBER;
+    }
+    return tok->type = JSON_TOK_ERROR;
+  }
+}
+
+bool JsonReader_SkipValue(JsonReader *r, const JsonToken *tok) {
+  if (tok->type != JSON_TOK_OBJECT_BEGIN && tok->type != JSON_TOK_ARRAY_BEGIN)
+    return tok->type != JSON_TOK_ERROR && tok->type != JSON_TOK_END;
+
+  // Nested containers only need a depth count, not a stack: the tokenizer
+  // doesn't check that brackets pair up anyway.
+  int depth = 1;
+  JsonToken t;
+  while (depth > 0) {
+    switch (JsonReader_Next(r, &t)) {
+    case JSON_TOK_OBJECT_BEGIN:
+    case JSON_TOK_ARRAY_BEGIN:
+      depth++;
+      break;
+    case JSON_TOK_OBJECT_END:
+    case JSON_TOK_ARRAY_END:
+      depth--;
+      break;
+    case JSON_TOK_ERROR:
+    case JSON_TOK_END:
+      return false;
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+bool JsonToken_Equals(const JsonToken *tok, const char *literal) {
+  size_t n = strlen(literal);
+  return tok->type == JSON_TOK_STRING && tok->length == n &&
+         memcmp(tok->start, literal, n) == 0;
+}
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+// Read 4 hex digits at s, or -1
+static long read_hex4(const char *s, const char *end) {
+  if (end - s < 4)
+    return -1;
+  long v = 0;
+  for (int i = 0; i < 4; i++) {
+    int h = hex_value(s[i]);
+    if (h < 0)
+      return -1;
+    v = (v << 4) | h;
+  }
+  return v;
+}
+
+static size_t encode_utf8(unsigned long cp, char *out) {
+  if (cp < 0x80) {
+    out[0] = (char)cp;
+    return 1;
+  }
+  if (cp < 0x800) {
+    out[0] = (char)(0xC0 | (cp >> 6));
+    out[1] = (char)(0x80 | (cp & 0x3F));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    out[0] = (char)(0xE0 | (cp >> 12));
+    out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[2] = (char)(0x80 | (cp & 0x3F));
+    return 3;
+  }
+  out[0] = (char)(0xF0 | (cp >> 18));
+  out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+  out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+  out[3] = (char)(0x80 | (cp & 0x3F));
+  return 4;
+}
+
+size_t JsonToken_DecodeString(const JsonToken *tok, char *out) {
+  if (!tok->hasEscapes) {
+    memcpy(out, tok->start, tok->length);
+    out[tok->length] = '\0';
+    return tok->length;
+  }
+
+  // Every escape sequence is at least as long as its decoded bytes, so the
+  // output never outgrows the raw token.
+  const char *s = tok->start;
+  const char *end = tok->start + tok->length;
+  size_t n = 0;
+  while (s < end) {
+    if (*s != '\\' || s + 1 >= end) {
+      out[n++] = *s++;
+      continue;
+    }
+    s++;
+    switch (*s++) {
+    case 'b':
+      out[n++] = '\b';
+      break;
+    case 'f':
+      out[n++] = '\f';
+      break;
+    case 'n':
+      out[n++] = '\n';
+      break;
+    case 'r':
+      out[n++] = '\r';
+      break;
+    case 't':
+      out[n++] = '\t';
+      break;
+    case 'u': {
+      long cp = read_hex4(s, end);
+      if (cp < 0)
+        break;
+      s += 4;
+      // Combine a UTF-16 surrogate pair when the low half follows
+      if (cp >= 0xD800 && cp <= 0xDBFF && end - s >= 6 && s[0] == '\\' &&
+          s[1] == 'u') {
+        long lo = read_hex4(s + 2, end);
+        if (lo >= 0xDC00 && lo <= 0xDFFF) {
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+          s += 6;
+        }
+      }
+      n += encode_utf8((unsigned long)cp, out + n);
+      break;
+    }
+    default: // '"', '\\', '/'
+      out[n++] = s[-1];
+      break;
+    }
+  }
+  out[n] = '\0';
+  return n;
+}
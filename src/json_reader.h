@@ -0,0 +1,49 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Allocation-free pull tokenizer over an in-memory JSON buffer. Tokens point
+// straight into the buffer; callers decode only the strings they keep and
+// skip everything else with JsonReader_SkipValue. Separators (',' and ':')
+// are consumed as whitespace, so the reader is tolerant rather than
+// validating: object members simply alternate key, value.
+typedef enum {
+  JSON_TOK_ERROR,
+  JSON_TOK_END,
+  JSON_TOK_OBJECT_BEGIN,
+  JSON_TOK_OBJECT_END,
+  JSON_TOK_ARRAY_BEGIN,
+  JSON_TOK_ARRAY_END,
+  JSON_TOK_STRING,
+  JSON_TOK_NUMBER,
+  JSON_TOK_TRUE,
+  JSON_TOK_FALSE,
+  JSON_TOK_NULL,
+} JsonTokenType;
+
+typedef struct {
+  JsonTokenType type;
+  const char *start; // For strings: first byte after the opening quote
+  size_t length;     // Raw length, escapes not yet decoded
+  bool hasEscapes;
+} JsonToken;
+
+typedef struct {
+  const char *pos;
+  const char *end;
+} JsonReader;
+
+void JsonReader_Init(JsonReader *r, const char *json, size_t length);
+JsonTokenType JsonReader_Next(JsonReader *r, JsonToken *tok);
+// Skip the rest of the value that tok started (a no-op for scalars)
+bool JsonReader_SkipValue(JsonReader *r, const JsonToken *tok);
+
+// True if a string token equals the given NUL-terminated literal
+bool JsonToken_Equals(const JsonToken *tok, const char *literal);
+// Decode a string token into out, which must hold tok->length + 1 bytes.
+// Returns the decoded length; out is NUL-terminated.
+size_t JsonToken_DecodeString(const JsonToken *tok, char *out);
+
+#endif
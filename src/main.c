@@ -3,13 +3,137 @@
 #include "clay.h"
 #include "clay_renderer_raylib.c"
 #include "google_auth.h"
+#include "http_client.h"
 #include "app_config.h"
 #include "oauth_server.h"
+#include "sync_worker.h"
+#include "text_measure.h"
 #include <curl/curl.h>
+#include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
+// ── Frame invalidation ───────────────────────────────────────────────────────
+// A frame is only laid out and drawn when something it depends on changed:
+// input, scrolling, the window, the synced data or the minute on the clock.
+// Otherwise the loop blocks in raylib's event waiting until the window gets
+// an event, or until frame_wake posts one: the sync worker does when it
+// publishes, and the clock thread at every minute. The minute tick moves the
+// now-line and also gives the refresh scheduler (asked from
+// Calendar_LoadEvents) a look at least once a minute.
+//
+// The wake needs GLFW's glfwPostEmptyEvent, which CMake finds in raylib (its
+// bundled GLFW) or in an external GLFW raylib was built against, and then
+// defines FELLA_HAVE_GLFW_WAKE. Without it the idle loop naps for
+// FRAME_IDLE_POLL_SECS between event polls instead of blocking.
+//
+// Frames drawn after the last change. Clicks and hover settle a layout after
+// the input that caused them.
+#define FRAME_SETTLE 2
+#define FRAME_IDLE_POLL_SECS 0.05
+
+typedef struct {
+  int width, height;
+  bool focused, minimized;
+  long minute;
+  const EventStore *store;
+  uint32_t generation;
+  int calendarCount;
+  bool syncing, resultReady;
+  int authState, oauthStatus;
+  Clay_Vector2 scroll[2];
+} FrameInputs;
+
+static Clay_Vector2 scroll_position(Clay_ElementId id) {
+  Clay_ScrollContainerData data = Clay_GetScrollContainerData(id);
+  return data.found && data.scrollPosition ? *data.scrollPosition
+                                           : (Clay_Vector2){0, 0};
+}
+
+static FrameInputs frame_inputs(void) {
+  return (FrameInputs){
+      .width = GetScreenWidth(),
+      .height = GetScreenHeight(),
+      .focused = IsWindowFocused(),
+      .minimized = IsWindowMinimized(),
+      .minute = (long)(time(NULL) / 60),
+      .store = g_eventStore,
+      .generation = g_eventStore->generation,
+      .calendarCount = g_calendarCount,
+      .syncing = SyncWorker_IsSyncing(),
+      .resultReady = SyncWorker_HasResult(),
+      .authState = (int)GoogleAuth_GetState(),
+      .oauthStatus = (int)g_oauthServerStatus,
+      // Momentum keeps these moving after the wheel stops
+      .scroll = {scroll_position(Clay_GetElementId(CLAY_STRING("ScrollArea"))),
+                 scroll_position(Clay_GetElementId(CLAY_STRING("CalList")))},
+  };
+}
+
+static bool frame_inputs_equal(const FrameInputs *a, const FrameInputs *b) {
+  for (int i = 0; i < 2; i++) {
+    if (a->scroll[i].x != b->scroll[i].x || a->scroll[i].y != b->scroll[i].y)
+      return false;
+  }
+  return a->width == b->width && a->height == b->height &&
+         a->focused == b->focused && a->minimized == b->minimized &&
+         a->minute == b->minute && a->store == b->store &&
+         a->generation == b->generation &&
+         a->calendarCount == b->calendarCount && a->syncing == b->syncing &&
+         a->resultReady == b->resultReady && a->authState == b->authState &&
+         a->oauthStatus == b->oauthStatus;
+}
+
+static bool has_input(void) {
+  Vector2 delta = GetMouseDelta();
+  Vector2 wheel = GetMouseWheelMoveV();
+  if (delta.x != 0.0f || delta.y != 0.0f || wheel.x != 0.0f ||
+      wheel.y != 0.0f || IsMouseButtonDown(0) || IsMouseButtonReleased(0))
+    return true;
+  // Key state rather than GetKeyPressed, which would take the key off the
+  // queue before the UI sees it
+  for (int key = KEY_SPACE; key <= KEY_KB_MENU; key++) {
+    if (IsKeyDown(key) || IsKeyReleased(key))
+      return true;
+  }
+  return false;
+}
+
+// ── Waking the idle loop ─────────────────────────────────────────────────────
+#ifdef FELLA_HAVE_GLFW_WAKE
+// raylib's desktop platform is GLFW, and raylib wraps no call that wakes
+// glfwWaitEvents from another thread; this one is safe from any thread.
+void glfwPostEmptyEvent(void);
+
+static void frame_wake(void) {
+  glfwPostEmptyEvent();
+}
+
+static pthread_t s_clockThread;
+static pthread_mutex_t s_clockMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_clockCond = PTHREAD_COND_INITIALIZER;
+static bool s_clockStop = false;
+
+// Wakes the loop at the start of every minute
+static void *clock_thread(void *arg) {
+  (void)arg;
+  pthread_mutex_lock(&s_clockMutex);
+  while (!s_clockStop) {
+    struct timespec next;
+    clock_gettime(CLOCK_REALTIME, &next);
+    next.tv_sec = (next.tv_sec / 60 + 1) * 60;
+    next.tv_nsec = 0;
+    if (pthread_cond_timedwait(&s_clockCond, &s_clockMutex, &next) ==
+        ETIMEDOUT)
+      frame_wake();
+  }
+  pthread_mutex_unlock(&s_clockMutex);
+  return NULL;
+}
+#endif
+
 const uint32_t FONT_ID_BODY_24 = 0;
 
 void HandleClayErrors(Clay_ErrorData errorData) {
@@ -33,6 +157,7 @@ Clay_RenderCommandArray CreateLayout(void) {
 
 int main(void) {
   curl_global_init(CURL_GLOBAL_DEFAULT);
+  HttpClient_Init();
   GoogleAuth_Init();
   AppConfig_Load();
 
@@ -49,11 +174,53 @@ int main(void) {
   fonts[FONT_ID_BODY_24] =
       LoadFontEx("resources/Inter-Regular.ttf", 48, 0, 400);
   SetTextureFilter(fonts[FONT_ID_BODY_24].texture, TEXTURE_FILTER_BILINEAR);
-  Clay_SetMeasureTextFunction(Raylib_MeasureText, fonts);
+  // Titles and labels are the same from frame to frame; measure each once
+  TextMeasure_Init(Raylib_MeasureText);
+  Clay_SetMeasureTextFunction(TextMeasure_Measure, fonts);
+
+#ifdef FELLA_HAVE_GLFW_WAKE
+  SyncWorker_SetWakeCallback(frame_wake);
+  // Without it the loop never blocks (see below)
+  bool clockRunning =
+      pthread_create(&s_clockThread, NULL, clock_thread, NULL) == 0;
+  bool canIdle = clockRunning;
+#else
+  bool canIdle = true;
+#endif
 
   bool scrollInitialized = false;
+  FrameInputs lastInputs = {0};
+  int settleFrames = FRAME_SETTLE;
+  bool waiting = false;
 
   while (!WindowShouldClose()) {
+    FrameInputs inputs = frame_inputs();
+    if (has_input() || IsWindowResized() ||
+        !frame_inputs_equal(&inputs, &lastInputs))
+      settleFrames = FRAME_SETTLE;
+    lastInputs = inputs;
+    // Nothing changed: keep the last frame on screen and block until an
+    // event. The first frames always run, until the initial scroll position
+    // is set.
+    if (settleFrames == 0 && scrollInitialized && canIdle) {
+#ifdef FELLA_HAVE_GLFW_WAKE
+      if (!waiting) {
+        EnableEventWaiting();
+        waiting = true;
+      }
+#else
+      WaitTime(FRAME_IDLE_POLL_SECS);
+#endif
+      PollInputEvents();
+      continue;
+    }
+    if (waiting) {
+      DisableEventWaiting();
+      waiting = false;
+    }
+    if (settleFrames > 0)
+      settleFrames--;
+
     Clay_SetPointerState(
         (Clay_Vector2){GetMousePosition().x, GetMousePosition().y},
         IsMouseButtonDown(0));
@@ -94,8 +261,28 @@ int main(void) {
     EndDrawing();
   }
 
+#ifdef FELLA_HAVE_GLFW_WAKE
+  if (clockRunning) {
+    pthread_mutex_lock(&s_clockMutex);
+    s_clockStop = true;
+    pthread_cond_signal(&s_clockCond);
+    pthread_mutex_unlock(&s_clockMutex);
+    pthread_join(s_clockThread, NULL);
+  }
+  SyncWorker_SetWakeCallback(NULL);
+#endif
+  SyncWorker_Stop();
   OAuthServer_Stop();
+  GoogleAuth_Stop();
   Clay_Raylib_Close();
+  TextMeasureStats measured = TextMeasure_GetStats();
+  uint64_t lookups = measured.hits + measured.misses;
+  fprintf(stderr, "Text measure cache: %llu/%llu hits (%.1f%%), %d entries\n",
+          (unsigned long long)measured.hits, (unsigned long long)lookups,
+          lookups ? 100.0 * (double)measured.hits / (double)lookups : 0.0,
+          measured.entries);
+  TextMeasure_Free();
+  HttpClient_Cleanup();
   curl_global_cleanup();
   return 0;
 }
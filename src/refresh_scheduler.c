@@ -0,0 +1,152 @@
+#include "refresh_scheduler.h"
+#include "events.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Poll intervals in seconds, by activity
+#define REFRESH_ACTIVE_SECS 120
+#define REFRESH_IDLE_SECS 600
+#define REFRESH_HIDDEN_SECS 1800
+// An event starting within REFRESH_IMMINENT_SECS polls every
+// REFRESH_IMMINENT_POLL_SECS, whatever the activity
+#define REFRESH_IMMINENT_SECS (15 * 60)
+#define REFRESH_IMMINENT_POLL_SECS 60
+// Backoff after the first failure, doubling per failure up to the cap
+#define REFRESH_BACKOFF_SECS 30
+#define REFRESH_BACKOFF_MAX_SECS 1800
+// Floor for a rate-limited calendar without a usable Retry-After
+#define REFRESH_RATE_LIMIT_SECS 60
+
+typedef struct {
+  char calendarId[CAL_CALID_LEN];
+  time_t lastPoll;  // When the last fetch finished, successful or not
+  time_t notBefore; // No fetch before this while backing off
+  int failures;     // Consecutive failed fetches
+} CalendarPoll;
+
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static CalendarPoll *s_polls = NULL;
+static int s_pollCount = 0;
+static int s_pollCapacity = 0;
+static RefreshActivity s_activity = REFRESH_ACTIVE;
+static time_t s_nextEvent = 0;
+static uint32_t s_rng = 0;
+
+// Called with s_mutex held. NULL if the table can't grow.
+static CalendarPoll *find_poll(const char *calendarId, bool create) {
+  for (int i = 0; i < s_pollCount; i++) {
+    if (strcmp(s_polls[i].calendarId, calendarId) == 0)
+      return &s_polls[i];
+  }
+  if (!create)
+    return NULL;
+  if (s_pollCount == s_pollCapacity) {
+    int cap = s_pollCapacity ? s_pollCapacity * 2 : 16;
+    CalendarPoll *polls = realloc(s_polls, sizeof(CalendarPoll) * (size_t)cap);
+    if (!polls)
+      return NULL;
+    s_polls = polls;
+    s_pollCapacity = cap;
+  }
+  CalendarPoll *p = &s_polls[s_pollCount++];
+  memset(p, 0, sizeof(*p));
+  strncpy(p->calendarId, calendarId, CAL_CALID_LEN - 1);
+  return p;
+}
+
+// xorshift32; only spreads retries apart, so any seed will do
+static uint32_t next_random(time_t now) {
+  if (!s_rng)
+    s_rng = (uint32_t)now ^ (uint32_t)(uintptr_t)&s_rng ^ 0x9E3779B9u;
+  s_rng ^= s_rng << 13;
+  s_rng ^= s_rng >> 17;
+  s_rng ^= s_rng << 5;
+  return s_rng;
+}
+
+// Called with s_mutex held
+static long poll_interval(time_t now) {
+  long interval = s_activity == REFRESH_ACTIVE ? REFRESH_ACTIVE_SECS
+                  : s_activity == REFRESH_IDLE ? REFRESH_IDLE_SECS
+                                               : REFRESH_HIDDEN_SECS;
+  if (s_nextEvent >= now && s_nextEvent - now <= REFRESH_IMMINENT_SECS &&
+      interval > REFRESH_IMMINENT_POLL_SECS)
+    interval = REFRESH_IMMINENT_POLL_SECS;
+  return interval;
+}
+
+void RefreshScheduler_SetActivity(RefreshActivity activity) {
+  pthread_mutex_lock(&s_mutex);
+  s_activity = activity;
+  pthread_mutex_unlock(&s_mutex);
+}
+
+void RefreshScheduler_SetNextEvent(time_t start) {
+  pthread_mutex_lock(&s_mutex);
+  s_nextEvent = start;
+  pthread_mutex_unlock(&s_mutex);
+}
+
+bool RefreshScheduler_PollDue(time_t now) {
+  pthread_mutex_lock(&s_mutex);
+  long interval = poll_interval(now);
+  bool due = false;
+  for (int i = 0; !due && i < s_pollCount; i++) {
+    const CalendarPoll *p = &s_polls[i];
+    due = now >= p->notBefore && now - p->lastPoll >= interval;
+  }
+  pthread_mutex_unlock(&s_mutex);
+  return due;
+}
+
+bool RefreshScheduler_MayFetch(const char *calendarId, time_t now) {
+  pthread_mutex_lock(&s_mutex);
+  const CalendarPoll *p = find_poll(calendarId, false);
+  bool ok = !p || now >= p->notBefore;
+  pthread_mutex_unlock(&s_mutex);
+  return ok;
+}
+
+void RefreshScheduler_Report(const char *calendarId, RefreshOutcome outcome,
+                             long retryAfter, time_t now) {
+  pthread_mutex_lock(&s_mutex);
+  CalendarPoll *p = find_poll(calendarId, true);
+  if (!p) {
+    pthread_mutex_unlock(&s_mutex);
+    return;
+  }
+  p->lastPoll = now;
+  if (outcome == REFRESH_OK) {
+    // Another week of the calendar failed earlier in the same sync; its
+    // backoff (and any Retry-After) stands
+    if (now >= p->notBefore) {
+      p->failures = 0;
+      p->notBefore = 0;
+    }
+    pthread_mutex_unlock(&s_mutex);
+    return;
+  }
+
+  // Other weeks of the same calendar failing in the same sync don't
+  // compound the backoff
+  if (now >= p->notBefore)
+    p->failures++;
+  long delay = REFRESH_BACKOFF_SECS;
+  for (int i = 1; i < p->failures && delay < REFRESH_BACKOFF_MAX_SECS; i++)
+    delay *= 2;
+  if (delay > REFRESH_BACKOFF_MAX_SECS)
+    delay = REFRESH_BACKOFF_MAX_SECS;
+  // Equal jitter: somewhere in [delay / 2, delay], so clients that failed
+  // together don't retry together
+  delay = delay / 2 + (long)(next_random(now) % (uint32_t)(delay / 2 + 1));
+  if (outcome == REFRESH_RATE_LIMITED && delay < REFRESH_RATE_LIMIT_SECS)
+    delay = REFRESH_RATE_LIMIT_SECS;
+  if (retryAfter > delay)
+    delay = retryAfter;
+  if (now + delay > p->notBefore)
+    p->notBefore = now + delay;
+  pthread_mutex_unlock(&s_mutex);
+}
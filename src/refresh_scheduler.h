@@ -0,0 +1,47 @@
+#ifndef REFRESH_SCHEDULER_H
+#define REFRESH_SCHEDULER_H
+
+#include <stdbool.h>
+#include <time.h>
+
+// Decides when Google calendars are polled again after a sync.
+//
+// The poll interval adapts to how the app is used: short while the window
+// is focused and in use or an event is about to start, longer when idle
+// and longest while minimized. Each calendar also backs off on its own
+// after failed fetches (exponential with jitter), and rate-limit responses
+// or a Retry-After header hold it off for at least as long as the server
+// asked. A calendar that is backing off isn't fetched by any sync, polled
+// or not.
+//
+// The renderer feeds in activity and asks whether a poll is due; the sync
+// worker asks before each fetch and reports how it went. Safe to call from
+// both threads.
+
+typedef enum {
+  REFRESH_HIDDEN, // Minimized
+  REFRESH_IDLE,   // Unfocused, or no input for a while
+  REFRESH_ACTIVE, // Focused and in use
+} RefreshActivity;
+
+typedef enum {
+  REFRESH_OK,
+  REFRESH_FAILED,       // Network error, 5xx or any other unusable response
+  REFRESH_RATE_LIMITED, // 429, or 403 with a rate-limit reason
+} RefreshOutcome;
+
+// Render thread
+void RefreshScheduler_SetActivity(RefreshActivity activity);
+// Start of the soonest upcoming timed event, 0 if there is none
+void RefreshScheduler_SetNextEvent(time_t start);
+// True once some calendar is due for a poll
+bool RefreshScheduler_PollDue(time_t now);
+
+// Sync worker. retryAfter is the server's Retry-After in seconds, 0 if none.
+// An OK ends a calendar's backoff only once it has run out, so a later week
+// succeeding can't undo an earlier week's failure in the same sync.
+bool RefreshScheduler_MayFetch(const char *calendarId, time_t now);
+void RefreshScheduler_Report(const char *calendarId, RefreshOutcome outcome,
+                             long retryAfter, time_t now);
+
+#endif
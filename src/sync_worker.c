@@ -0,0 +1,470 @@
+#include "sync_worker.h"
+#include "event_cache.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Reloads of one calendar requested this close together are merged
+#define SYNC_RELOAD_WINDOW_MS 2000
+
+static pthread_t s_thread;
+static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond = PTHREAD_COND_INITIALIZER;
+static bool s_running = false;
+static bool s_stop = false;
+
+// One sync's worth of request, copied out from under the lock
+typedef struct {
+  LinkedCalendar *calendars;
+  int count, capacity;
+  int weeks[CAL_PREFETCH_WEEKS];
+  int weekCount;
+  bool discover;
+  CalendarSyncPhase phase;
+  // Calendars to refetch from scratch, taken from s_reloads with the job
+  LinkedCalendar *reloads;
+  int reloadCount, reloadCapacity;
+} SyncJob;
+
+typedef struct {
+  LinkedCalendar calendar;
+  long long requestedMs;
+} RecentReload;
+
+// Guarded by s_mutex
+static bool s_requested = false;
+static SyncJob s_request;
+static EventStore *s_back = NULL; // NULL while the worker is filling it
+static LinkedCalendar *s_resultCalendars = NULL; // Published with s_result
+static int s_resultCount = 0;
+// Reloads for the next job, and every reload requested within the last
+// SYNC_RELOAD_WINDOW_MS (queued or already running)
+static LinkedCalendar *s_reloads = NULL;
+static int s_reloadCount = 0;
+static int s_reloadCapacity = 0;
+static RecentReload *s_recentReloads = NULL;
+static int s_recentCount = 0;
+static int s_recentCapacity = 0;
+
+// Written by the worker, taken by the renderer (atomic so the per-frame
+// check in SyncWorker_Swap doesn't need the lock)
+static EventStore *s_result = NULL;
+static void (*s_wake)(void) = NULL; // Guarded by s_mutex
+static int s_syncing = 0;
+
+// Worker-owned copy of everything synced so far, patched in place by
+// incremental syncs. Each published store is a compacted copy of it, and
+// s_calendars is the list its calendarIndex values refer to.
+static EventStore s_synced;
+static LinkedCalendar *s_calendars = NULL;
+static int s_calendarCount = 0;
+
+// A generation of s_synced together with the calendar list it was indexed
+// by, so syncs that changed nothing (all 304s, empty deltas) can be told
+// apart from ones that did
+typedef struct {
+  bool valid;
+  uint32_t generation;
+  LinkedCalendar *calendars;
+  int count;
+} SyncedMark;
+
+static SyncedMark s_saved;     // What the event cache holds
+static SyncedMark s_published; // What the renderer's newest store holds
+
+static LinkedCalendar *copy_calendars(const LinkedCalendar *calendars,
+                                      int count) {
+  LinkedCalendar *copy = malloc(sizeof(LinkedCalendar) * (size_t)(count + 1));
+  if (copy)
+    memcpy(copy, calendars, sizeof(LinkedCalendar) * (size_t)count);
+  return copy;
+}
+
+static bool mark_current(const SyncedMark *mark) {
+  return mark->valid && mark->generation == s_synced.generation &&
+         mark->count == s_calendarCount &&
+         memcmp(mark->calendars, s_calendars,
+                sizeof(LinkedCalendar) * (size_t)s_calendarCount) == 0;
+}
+
+static void mark_set(SyncedMark *mark) {
+  free(mark->calendars);
+  mark->calendars = copy_calendars(s_calendars, s_calendarCount);
+  mark->count = s_calendarCount;
+  mark->generation = s_synced.generation;
+  mark->valid = mark->calendars != NULL;
+}
+
+// Save s_synced unless the cache already holds this generation of it
+static void save_cache(void) {
+  if (!mark_current(&s_saved) &&
+      EventCache_Save(&s_synced, s_calendars, s_calendarCount))
+    mark_set(&s_saved);
+}
+
+static bool same_calendar(const LinkedCalendar *a, const LinkedCalendar *b) {
+  // filePath and calendarId share storage, so one compare covers both
+  return a->source == b->source && strcmp(a->calendarId, b->calendarId) == 0;
+}
+
+static long long now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// Append cal to a growable list; false if out of memory
+static bool list_push(LinkedCalendar **list, int *count, int *capacity,
+                      const LinkedCalendar *cal) {
+  if (*count == *capacity) {
+    int cap = *capacity ? *capacity * 2 : 8;
+    LinkedCalendar *grown = realloc(*list, sizeof(LinkedCalendar) * (size_t)cap);
+    if (!grown)
+      return false;
+    *list = grown;
+    *capacity = cap;
+  }
+  (*list)[(*count)++] = *cal;
+  return true;
+}
+
+// Hand the pending reloads to job. Called with s_mutex held.
+static void take_reloads_locked(SyncJob *job) {
+  job->reloadCount = 0;
+  for (int i = 0; i < s_reloadCount; i++) {
+    if (!list_push(&job->reloads, &job->reloadCount, &job->reloadCapacity,
+                   &s_reloads[i]))
+      fprintf(stderr, "Out of memory, calendar reload dropped\n");
+  }
+  s_reloadCount = 0;
+}
+
+static bool job_copy(SyncJob *dst, const SyncJob *src) {
+  if (src->count > dst->capacity) {
+    LinkedCalendar *calendars =
+        realloc(dst->calendars, sizeof(LinkedCalendar) * (size_t)src->count);
+    if (!calendars)
+      return false;
+    dst->calendars = calendars;
+    dst->capacity = src->count;
+  }
+  memcpy(dst->calendars, src->calendars,
+         sizeof(LinkedCalendar) * (size_t)src->count);
+  dst->count = src->count;
+  memcpy(dst->weeks, src->weeks, sizeof(int) * (size_t)src->weekCount);
+  dst->weekCount = src->weekCount;
+  dst->discover = src->discover;
+  dst->phase = src->phase;
+  return true;
+}
+
+// Settle the list this sync runs with: a fresh discovery if asked for
+// (keeping the current list when that fails offline), else the current list
+// with the renderer's visibility applied
+static void update_calendars(const SyncJob *job) {
+  if (job->discover || !s_calendars) {
+    int count = 0;
+    LinkedCalendar *found =
+        job->discover
+            ? Calendar_DiscoverCalendars(job->calendars, job->count, &count)
+            : NULL;
+    if (!found && (!s_calendars || !job->discover)) {
+      found = copy_calendars(job->calendars, job->count);
+      count = job->count;
+    }
+    if (found) {
+      free(s_calendars);
+      s_calendars = found;
+      s_calendarCount = count;
+    }
+    return;
+  }
+  for (int i = 0; i < s_calendarCount; i++) {
+    for (int j = 0; j < job->count; j++) {
+      if (s_calendars[i].source == job->calendars[j].source &&
+          strcmp(s_calendars[i].calendarId, job->calendars[j].calendarId) ==
+              0) {
+        s_calendars[i].visible = job->calendars[j].visible;
+        break;
+      }
+    }
+  }
+}
+
+// Fills store for publishing, with *calendars the list it is indexed by
+// (malloc'd, NULL if out of memory). False with store untouched if the sync
+// changed nothing the renderer doesn't already have.
+static bool run_sync(EventStore *store, const SyncJob *job,
+                     LinkedCalendar **calendars, int *count) {
+  update_calendars(job);
+
+  // Reloads address calendars by id; the list may have been rediscovered
+  bool *reload = NULL;
+  if (job->reloadCount > 0) {
+    reload = calloc((size_t)s_calendarCount + 1, sizeof(bool));
+    for (int i = 0; reload && i < s_calendarCount; i++) {
+      for (int j = 0; j < job->reloadCount; j++)
+        reload[i] |= same_calendar(&s_calendars[i], &job->reloads[j]);
+    }
+  }
+  Calendar_LoadCalendars(&s_synced, s_calendars, s_calendarCount, job->weeks,
+                         job->weekCount, job->phase, reload);
+  free(reload);
+
+  if (job->phase != CAL_SYNC_ON_SCREEN) {
+    // Snapshot for the next cold start (and for running offline)
+    save_cache();
+  }
+  // Republishing an unchanged store would only make the renderer drop its
+  // per-store state (the open event popup among it)
+  *calendars = NULL;
+  *count = 0;
+  if (mark_current(&s_published))
+    return false;
+  if (!EventStore_CopyFrom(store, &s_synced))
+    fprintf(stderr, "Out of memory while publishing events\n");
+
+  // Deltas strand replaced strings in the arena; once that outweighs the
+  // live data, swap in the compact copy's contents. The events stay the
+  // same, so the marks of this generation carry over.
+  if (job->phase != CAL_SYNC_ON_SCREEN &&
+      Arena_BytesUsed(&s_synced.arena) > 2 * Arena_BytesUsed(&store->arena)) {
+    bool saved = mark_current(&s_saved);
+    EventStore_CopyFrom(&s_synced, store);
+    if (saved)
+      s_saved.generation = s_synced.generation;
+  }
+  mark_set(&s_published);
+  *calendars = copy_calendars(s_calendars, s_calendarCount);
+  if (*calendars)
+    *count = s_calendarCount;
+  return true;
+}
+
+// Publish a finished phase (or, if it changed nothing, hand store back as
+// the back buffer) and queue the background phase after an on-screen one,
+// unless a newer request already superseded it. Called with s_mutex held.
+static void publish_locked(EventStore *store, bool changed,
+                           LinkedCalendar *calendars, int count,
+                           CalendarSyncPhase phase) {
+  if (changed) {
+    free(s_resultCalendars);
+    s_resultCalendars = calendars;
+    s_resultCount = count;
+    __atomic_store_n(&s_result, store, __ATOMIC_RELEASE);
+  } else {
+    s_back = store;
+  }
+  if (!s_requested && phase == CAL_SYNC_ON_SCREEN) {
+    s_request.phase = CAL_SYNC_BACKGROUND;
+    s_request.discover = false;
+    s_requested = true;
+  }
+  if (!s_requested)
+    __atomic_store_n(&s_syncing, 0, __ATOMIC_RELEASE);
+  if (s_wake)
+    s_wake();
+}
+
+static void *worker_thread(void *arg) {
+  (void)arg;
+  SyncJob job = {0};
+
+  pthread_mutex_lock(&s_mutex);
+  for (;;) {
+    // Wait for a request and for the renderer to have taken the last result,
+    // which is what returns a back buffer to us
+    while (!s_stop && (!s_requested || !s_back))
+      pthread_cond_wait(&s_cond, &s_mutex);
+    if (s_stop)
+      break;
+
+    if (!job_copy(&job, &s_request)) {
+      // Retried on the next request
+      s_requested = false;
+      __atomic_store_n(&s_syncing, 0, __ATOMIC_RELEASE);
+      continue;
+    }
+    s_requested = false;
+    s_request.discover = false;
+    take_reloads_locked(&job);
+    EventStore *store = s_back;
+    s_back = NULL;
+    pthread_mutex_unlock(&s_mutex);
+
+    LinkedCalendar *calendars;
+    int count;
+    bool changed = run_sync(store, &job, &calendars, &count);
+
+    pthread_mutex_lock(&s_mutex);
+    publish_locked(store, changed, calendars, count, job.phase);
+  }
+  pthread_mutex_unlock(&s_mutex);
+  free(job.calendars);
+  free(job.reloads);
+  return NULL;
+}
+
+// Without a thread the caller does the work, but the result still goes
+// through s_result so the renderer swaps exactly as for the threaded path.
+// Called with s_mutex held.
+static void sync_inline_locked(void) {
+  if (s_running || !s_requested || !s_back)
+    return;
+  EventStore *store = s_back;
+  s_back = NULL;
+  s_requested = false;
+  CalendarSyncPhase phase = s_request.phase;
+  take_reloads_locked(&s_request);
+  LinkedCalendar *calendars;
+  int count;
+  bool changed = run_sync(store, &s_request, &calendars, &count);
+  s_request.discover = false;
+  s_request.reloadCount = 0;
+  publish_locked(store, changed, calendars, count, phase);
+  // Nothing for the renderer to swap in, so no swap will run the background
+  // phase this queued
+  if (!changed)
+    sync_inline_locked();
+}
+
+bool SyncWorker_Start(EventStore *back) {
+  if (s_running)
+    return true;
+  s_stop = false;
+  s_back = back;
+  if (pthread_create(&s_thread, NULL, worker_thread, NULL) != 0) {
+    fprintf(stderr, "Could not start sync worker, syncing inline\n");
+    return false;
+  }
+  s_running = true;
+  return true;
+}
+
+void SyncWorker_Request(const LinkedCalendar *calendars, int count,
+                        const int *weeks, int weekCount, bool discover) {
+  if (weekCount > CAL_PREFETCH_WEEKS)
+    weekCount = CAL_PREFETCH_WEEKS;
+
+  pthread_mutex_lock(&s_mutex);
+  // A pending discovery isn't dropped by a later request that doesn't ask
+  SyncJob req = {(LinkedCalendar *)calendars, count, count, {0}, weekCount,
+                 discover || (s_requested && s_request.discover),
+                 CAL_SYNC_ON_SCREEN, NULL, 0, 0};
+  memcpy(req.weeks, weeks, sizeof(int) * (size_t)weekCount);
+  if (job_copy(&s_request, &req)) {
+    s_requested = true;
+    __atomic_store_n(&s_syncing, 1, __ATOMIC_RELEASE);
+    sync_inline_locked();
+    pthread_cond_signal(&s_cond);
+  } else {
+    fprintf(stderr, "Out of memory, sync request dropped\n");
+  }
+  pthread_mutex_unlock(&s_mutex);
+}
+
+void SyncWorker_RequestReload(const LinkedCalendar *calendars, int count,
+                              int calIndex) {
+  if (calIndex < 0 || calIndex >= count)
+    return;
+  const LinkedCalendar *cal = &calendars[calIndex];
+  long long now = now_ms();
+
+  pthread_mutex_lock(&s_mutex);
+  int kept = 0;
+  bool duplicate = false;
+  for (int i = 0; i < s_recentCount; i++) {
+    if (now - s_recentReloads[i].requestedMs >= SYNC_RELOAD_WINDOW_MS)
+      continue;
+    duplicate |= same_calendar(&s_recentReloads[i].calendar, cal);
+    s_recentReloads[kept++] = s_recentReloads[i];
+  }
+  s_recentCount = kept;
+  if (duplicate) {
+    // Joins the reload already queued or running
+    pthread_mutex_unlock(&s_mutex);
+    return;
+  }
+
+  if (s_recentCount == s_recentCapacity) {
+    int cap = s_recentCapacity ? s_recentCapacity * 2 : 8;
+    RecentReload *grown =
+        realloc(s_recentReloads, sizeof(RecentReload) * (size_t)cap);
+    if (grown) {
+      s_recentReloads = grown;
+      s_recentCapacity = cap;
+    }
+  }
+  if (s_recentCount < s_recentCapacity)
+    s_recentReloads[s_recentCount++] = (RecentReload){*cal, now};
+
+  bool ok = list_push(&s_reloads, &s_reloadCount, &s_reloadCapacity, cal);
+  if (ok && !s_requested) {
+    // Nothing else queued: a job for just the reloaded calendars, over the
+    // weeks of the last request
+    SyncJob req = {(LinkedCalendar *)calendars, count, count, {0},
+                   s_request.weekCount, false, CAL_SYNC_RELOAD, NULL, 0, 0};
+    memcpy(req.weeks, s_request.weeks, sizeof(req.weeks));
+    ok = job_copy(&s_request, &req);
+  }
+  if (ok) {
+    s_requested = true;
+    __atomic_store_n(&s_syncing, 1, __ATOMIC_RELEASE);
+    sync_inline_locked();
+    pthread_cond_signal(&s_cond);
+  } else {
+    fprintf(stderr, "Out of memory, calendar reload dropped\n");
+  }
+  pthread_mutex_unlock(&s_mutex);
+}
+
+EventStore *SyncWorker_Swap(EventStore *front, LinkedCalendar **calendars,
+                            int *count) {
+  *calendars = NULL;
+  *count = 0;
+  if (!__atomic_load_n(&s_result, __ATOMIC_ACQUIRE))
+    return front;
+
+  pthread_mutex_lock(&s_mutex);
+  EventStore *fresh = s_result;
+  __atomic_store_n(&s_result, NULL, __ATOMIC_RELEASE);
+  *calendars = s_resultCalendars;
+  *count = s_resultCount;
+  s_resultCalendars = NULL;
+  s_back = front;
+  // A request that queued up behind this result can run now
+  sync_inline_locked();
+  pthread_cond_signal(&s_cond);
+  pthread_mutex_unlock(&s_mutex);
+  return fresh;
+}
+
+bool SyncWorker_IsSyncing(void) {
+  return __atomic_load_n(&s_syncing, __ATOMIC_ACQUIRE) != 0 ||
+         __atomic_load_n(&s_result, __ATOMIC_ACQUIRE) != NULL;
+}
+
+void SyncWorker_SetWakeCallback(void (*wake)(void)) {
+  pthread_mutex_lock(&s_mutex);
+  s_wake = wake;
+  pthread_mutex_unlock(&s_mutex);
+}
+
+bool SyncWorker_HasResult(void) {
+  return __atomic_load_n(&s_result, __ATOMIC_ACQUIRE) != NULL;
+}
+
+void SyncWorker_Stop(void) {
+  if (!s_running)
+    return;
+  pthread_mutex_lock(&s_mutex);
+  s_stop = true;
+  pthread_cond_signal(&s_cond);
+  pthread_mutex_unlock(&s_mutex);
+  // Waits out a fetch already in flight
+  pthread_join(s_thread, NULL);
+  s_running = false;
+}
@@ -0,0 +1,55 @@
+#ifndef SYNC_WORKER_H
+#define SYNC_WORKER_H
+
+#include "events.h"
+
+#include <stdbool.h>
+
+// Background thread that fetches and parses events off the render thread.
+//
+// Stores are double buffered: the renderer reads the front store while the
+// worker fills the back one. A finished store is published through an
+// atomic pointer and only handed to the renderer by SyncWorker_Swap, which
+// gives the old front back to the worker as its next back buffer. Neither
+// side ever touches a store the other one owns.
+
+// The worker owns the calendar list its stores are indexed by. It is
+// rediscovered from Google on request and published with every store, so
+// the renderer always holds the list matching the store on screen.
+//
+// Each request syncs in two phases (see CalendarSyncPhase), each published
+// as soon as it is done. A phase that changed neither the events nor the
+// calendar list publishes nothing, so the renderer keeps its store (and
+// whatever it holds indices into) across polls that only saw 304s.
+
+// back is the store the first sync fills
+bool SyncWorker_Start(EventStore *back);
+// Queue a sync of the given weeks (copied). calendars is the renderer's
+// list: it seeds the worker's list when discover is set (the worker then
+// fetches the full calendar list) and otherwise only passes on visibility.
+// Requests made while a sync is running are merged into a single follow-up
+// sync of the latest one.
+void SyncWorker_Request(const LinkedCalendar *calendars, int count,
+                        const int *weeks, int weekCount, bool discover);
+// Queue a from-scratch refetch of calendars[calIndex] alone, over the weeks
+// of the last request. It rides along with a sync that is already queued;
+// another reload of the same calendar within two seconds joins the first
+// instead of queueing a second one.
+void SyncWorker_RequestReload(const LinkedCalendar *calendars, int count,
+                              int calIndex);
+// Called by the renderer once per frame. Returns the newly synced store if
+// one was published, otherwise front unchanged. With a new store,
+// *calendars gets the malloc'd calendar list it is indexed by (caller
+// frees); otherwise it is set to NULL.
+EventStore *SyncWorker_Swap(EventStore *front, LinkedCalendar **calendars,
+                            int *count);
+bool SyncWorker_IsSyncing(void);
+// True while a finished store waits for SyncWorker_Swap (lock-free)
+bool SyncWorker_HasResult(void);
+// Called after each publish (on the worker thread, or the caller's when
+// syncing inline), so a renderer blocked waiting for input can pick the
+// result up. NULL to stop.
+void SyncWorker_SetWakeCallback(void (*wake)(void));
+void SyncWorker_Stop(void);
+
+#endif
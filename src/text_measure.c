@@ -0,0 +1,117 @@
+#include "text_measure.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Open addressing, grown at 3/4 load up to TEXT_MEASURE_MAX_SLOTS; a full
+// table at the cap starts over rather than evicting entry by entry
+#define TEXT_MEASURE_MIN_SLOTS 1024
+#define TEXT_MEASURE_MAX_SLOTS 65536
+
+typedef struct {
+  uint64_t key; // 0 = empty
+  int32_t length;
+  Clay_Dimensions size;
+} MeasureEntry;
+
+static TextMeasureFn s_measure = NULL;
+static MeasureEntry *s_slots = NULL;
+static int s_slotCount = 0; // Power of two
+static int s_used = 0;
+static uint64_t s_hits = 0;
+static uint64_t s_misses = 0;
+
+static uint64_t fnv_mix(uint64_t h, const void *data, size_t len) {
+  const unsigned char *p = data;
+  for (size_t i = 0; i < len; i++) {
+    h ^= p[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+static uint64_t measure_key(Clay_StringSlice text,
+                            const Clay_TextElementConfig *config) {
+  uint64_t h = 1469598103934665603ull; // FNV-1a
+  h = fnv_mix(h, text.chars, (size_t)text.length);
+  h = fnv_mix(h, &config->fontId, sizeof(config->fontId));
+  h = fnv_mix(h, &config->fontSize, sizeof(config->fontSize));
+  h = fnv_mix(h, &config->letterSpacing, sizeof(config->letterSpacing));
+  return h ? h : 1;
+}
+
+static MeasureEntry *find_slot(MeasureEntry *slots, int slotCount,
+                               uint64_t key, int32_t length) {
+  int mask = slotCount - 1;
+  for (int i = (int)(key & (uint64_t)mask);; i = (i + 1) & mask) {
+    MeasureEntry *e = &slots[i];
+    if (!e->key || (e->key == key && e->length == length))
+      return e;
+  }
+}
+
+// False if there is no room and the table couldn't grow
+static bool reserve_slot(void) {
+  if (s_slotCount && (s_used + 1) * 4 <= s_slotCount * 3)
+    return true;
+  if (s_slotCount >= TEXT_MEASURE_MAX_SLOTS) {
+    TextMeasure_Invalidate();
+    return true;
+  }
+  int count = s_slotCount ? s_slotCount * 2 : TEXT_MEASURE_MIN_SLOTS;
+  MeasureEntry *slots = calloc((size_t)count, sizeof(MeasureEntry));
+  if (!slots)
+    return false;
+  for (int i = 0; i < s_slotCount; i++) {
+    if (s_slots[i].key)
+      *find_slot(slots, count, s_slots[i].key, s_slots[i].length) =
+          s_slots[i];
+  }
+  free(s_slots);
+  s_slots = slots;
+  s_slotCount = count;
+  return true;
+}
+
+void TextMeasure_Init(TextMeasureFn fn) {
+  s_measure = fn;
+}
+
+Clay_Dimensions TextMeasure_Measure(Clay_StringSlice text,
+                                    Clay_TextElementConfig *config,
+                                    void *userData) {
+  uint64_t key = measure_key(text, config);
+  if (s_slotCount) {
+    MeasureEntry *e = find_slot(s_slots, s_slotCount, key, text.length);
+    if (e->key) {
+      s_hits++;
+      return e->size;
+    }
+  }
+
+  s_misses++;
+  Clay_Dimensions size = s_measure(text, config, userData);
+  if (reserve_slot()) {
+    MeasureEntry *e = find_slot(s_slots, s_slotCount, key, text.length);
+    *e = (MeasureEntry){key, text.length, size};
+    s_used++;
+  }
+  return size;
+}
+
+void TextMeasure_Invalidate(void) {
+  if (s_slots)
+    memset(s_slots, 0, sizeof(MeasureEntry) * (size_t)s_slotCount);
+  s_used = 0;
+}
+
+TextMeasureStats TextMeasure_GetStats(void) {
+  return (TextMeasureStats){s_hits, s_misses, s_used};
+}
+
+void TextMeasure_Free(void) {
+  free(s_slots);
+  s_slots = NULL;
+  s_slotCount = 0;
+  s_used = 0;
+}
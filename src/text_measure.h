@@ -0,0 +1,34 @@
+#ifndef TEXT_MEASURE_H
+#define TEXT_MEASURE_H
+
+#include "clay.h"
+
+#include <stdint.h>
+
+// Remembers text measurements across frames, in front of the renderer's
+// glyph-walking measure function. Entries are keyed by a hash of the text
+// together with the font id, size and letter spacing, and only dropped by
+// TextMeasure_Invalidate (after reloading fonts) or when the table is full.
+// Render thread only.
+
+typedef Clay_Dimensions (*TextMeasureFn)(Clay_StringSlice text,
+                                         Clay_TextElementConfig *config,
+                                         void *userData);
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  int entries;
+} TextMeasureStats;
+
+// Measure misses with fn
+void TextMeasure_Init(TextMeasureFn fn);
+// Drop-in for Clay_SetMeasureTextFunction
+Clay_Dimensions TextMeasure_Measure(Clay_StringSlice text,
+                                    Clay_TextElementConfig *config,
+                                    void *userData);
+void TextMeasure_Invalidate(void);
+TextMeasureStats TextMeasure_GetStats(void);
+void TextMeasure_Free(void);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+
+#include <stdio.h>
+
+// Failed checks are counted rather than fatal, so one run reports them all;
+// main returns CHECK_RESULT()
+static int s_failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+      s_failures++;                                                            \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_RESULT()                                                         \
+  (s_failures ? (fprintf(stderr, "%d check(s) failed\n", s_failures), 1) : 0)
+
+#endif
@@ -0,0 +1,89 @@
+// DateTime_ParseRFC3339 and the civil-day conversions it is built on.
+// Expected epochs come from Python's calendar.timegm.
+#include "check.h"
+#include "datetime.h"
+
+static bool parses_to(const char *s, time_t expected) {
+  time_t t = 0;
+  return DateTime_ParseRFC3339(s, &t) && t == expected;
+}
+
+static bool rejects(const char *s) {
+  time_t t = 12345;
+  return !DateTime_ParseRFC3339(s, &t) && t == 12345;
+}
+
+static void test_offsets(void) {
+  // 2026-02-27T14:00:00Z
+  const time_t utc = 1772200800;
+  CHECK(parses_to("2026-02-27T14:00:00Z", utc));
+  CHECK(parses_to("2026-02-27t14:00:00z", utc));
+  CHECK(parses_to("2026-02-27T09:00:00-05:00", utc));
+  CHECK(parses_to("2026-02-27T15:00:00+01:00", utc));
+  CHECK(parses_to("2026-02-27 15:00:00+0100", utc));
+  CHECK(parses_to("2026-02-27T19:30:00+05:30", utc));
+  // No offset reads as UTC
+  CHECK(parses_to("2026-02-27T14:00:00", utc));
+  // Offsets cross the day boundary
+  CHECK(parses_to("2026-02-28T00:00:00+10:00", utc));
+  CHECK(parses_to("2026-02-27T00:00:00-08:00", 1772179200));
+}
+
+static void test_fractions(void) {
+  const time_t utc = 1772200800;
+  CHECK(parses_to("2026-02-27T14:00:00.250Z", utc));
+  CHECK(parses_to("2026-02-27T14:00:00.999999999-00:00", utc));
+  CHECK(parses_to("2026-02-27T14:00:00,5Z", utc));
+  CHECK(rejects("2026-02-27T14:00:00.Z"));
+}
+
+static void test_dates(void) {
+  CHECK(parses_to("2024-02-29T00:00:00Z", 1709164800));
+  CHECK(parses_to("1969-12-31T23:59:59Z", -1));
+  CHECK(parses_to("1970-01-01T00:00:00Z", 0));
+
+  int y, m, d;
+  CHECK(DateTime_ParseDate("2024-02-29", &y, &m, &d) && y == 2024 &&
+        m == 2 && d == 29);
+  CHECK(!DateTime_ParseDate("2023-02-29", &y, &m, &d));
+  CHECK(!DateTime_ParseDate("1900-02-29", &y, &m, &d));
+  CHECK(DateTime_ParseDate("2000-02-29", &y, &m, &d));
+
+  // Round trip over four centuries either side of the epoch
+  bool roundTrip = true;
+  for (int64_t days = -146097; days <= 146097 && roundTrip; days += 13) {
+    DateTime_CivilFromDays(days, &y, &m, &d);
+    roundTrip = DateTime_DaysFromCivil(y, m, d) == days;
+  }
+  CHECK(roundTrip);
+  CHECK(DateTime_DaysFromCivil(1970, 1, 1) == 0);
+  CHECK(DateTime_DaysFromCivil(2000, 3, 1) == 11017);
+}
+
+static void test_invalid(void) {
+  CHECK(rejects(""));
+  CHECK(rejects("2026-02-27"));
+  CHECK(rejects("2026-02-27T"));
+  CHECK(rejects("2026-02-27T14:00"));
+  CHECK(rejects("2026-02-27X14:00:00Z"));
+  CHECK(rejects("2026-13-01T00:00:00Z"));
+  CHECK(rejects("2026-00-01T00:00:00Z"));
+  CHECK(rejects("2026-02-30T00:00:00Z"));
+  CHECK(rejects("2026-02-27T24:00:00Z"));
+  CHECK(rejects("2026-02-27T14:60:00Z"));
+  CHECK(rejects("2026-02-27T14:00:61Z"));
+  CHECK(rejects("2026-02-27T14:00:00+24:00"));
+  CHECK(rejects("2026-02-27T14:00:00+05:6"));
+  CHECK(rejects("2026-02-27T14:00:00+5"));
+  CHECK(rejects("26-02-27T14:00:00Z"));
+  CHECK(rejects("2026/02/27T14:00:00Z"));
+  CHECK(rejects("not a timestamp"));
+}
+
+int main(void) {
+  test_offsets();
+  test_fractions();
+  test_dates();
+  test_invalid();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,142 @@
+// DayLayout_Pack: hand-checked clusters, then lane invariants over random
+// days.
+#include "check.h"
+#include "day_layout.h"
+#include "events.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define DAY 19000
+
+static int add_timed(EventStore *store, int startMinute, int endMinute) {
+  int i = EventStore_Append(store);
+  store->items[i].startDay = DAY;
+  store->items[i].endDay = endMinute >= 24 * 60 ? DAY + 1 : DAY;
+  store->items[i].startMinute = (int16_t)startMinute;
+  store->items[i].endMinute = (int16_t)(endMinute % (24 * 60));
+  return i;
+}
+
+static void pack_all(const EventStore *store, int minMinutes, EventLane *out) {
+  int events[64];
+  for (int i = 0; i < store->count; i++)
+    events[i] = i;
+  DayLayout_Pack(store, events, store->count, minMinutes, out);
+}
+
+static bool lane_is(const EventLane *l, int lane, int laneCount) {
+  return l->lane == lane && l->laneCount == laneCount;
+}
+
+static void test_clusters(void) {
+  EventStore store = {0};
+  EventLane out[64];
+  // Back to back: touching isn't overlapping
+  add_timed(&store, 9 * 60, 10 * 60);
+  add_timed(&store, 10 * 60, 11 * 60);
+  // Three at once
+  add_timed(&store, 12 * 60, 14 * 60);
+  add_timed(&store, 12 * 60 + 30, 13 * 60 + 30);
+  add_timed(&store, 13 * 60, 15 * 60);
+  // A chain: the first and last don't overlap, yet share a cluster, and
+  // the last reuses the first's lane
+  add_timed(&store, 16 * 60, 17 * 60);
+  add_timed(&store, 16 * 60 + 30, 18 * 60);
+  add_timed(&store, 17 * 60 + 30, 19 * 60);
+  // Runs past midnight: packed as ending at 24:00
+  add_timed(&store, 23 * 60, 25 * 60);
+  add_timed(&store, 23 * 60 + 30, 23 * 60 + 45);
+  pack_all(&store, 0, out);
+
+  CHECK(lane_is(&out[0], 0, 1));
+  CHECK(lane_is(&out[1], 0, 1));
+  CHECK(lane_is(&out[2], 0, 3));
+  CHECK(lane_is(&out[3], 1, 3));
+  CHECK(lane_is(&out[4], 2, 3));
+  CHECK(lane_is(&out[5], 0, 2));
+  CHECK(lane_is(&out[6], 1, 2));
+  CHECK(lane_is(&out[7], 0, 2));
+  CHECK(lane_is(&out[8], 0, 2));
+  CHECK(lane_is(&out[9], 1, 2));
+  EventStore_Clear(&store);
+}
+
+static void test_min_minutes(void) {
+  EventStore store = {0};
+  EventLane out[64];
+  // Zero-length events ten minutes apart overlap once drawn 20 minutes tall
+  add_timed(&store, 9 * 60, 9 * 60);
+  add_timed(&store, 9 * 60 + 10, 9 * 60 + 10);
+  add_timed(&store, 9 * 60 + 40, 9 * 60 + 40);
+  pack_all(&store, 20, out);
+  CHECK(lane_is(&out[0], 0, 2));
+  CHECK(lane_is(&out[1], 1, 2));
+  CHECK(lane_is(&out[2], 0, 1));
+
+  // Same start: the longer one takes the leftmost lane
+  EventStore_Clear(&store);
+  add_timed(&store, 8 * 60, 8 * 60 + 30);
+  add_timed(&store, 8 * 60, 10 * 60);
+  pack_all(&store, 0, out);
+  CHECK(lane_is(&out[0], 1, 2));
+  CHECK(lane_is(&out[1], 0, 2));
+  EventStore_Clear(&store);
+}
+
+static uint32_t s_rng = 777;
+
+static int random_below(int n) {
+  s_rng ^= s_rng << 13;
+  s_rng ^= s_rng >> 17;
+  s_rng ^= s_rng << 5;
+  return (int)(s_rng % (uint32_t)n);
+}
+
+// Overlap of the drawn extents, as the packer sees them
+static bool overlaps(const CalEvent *a, const CalEvent *b, int minMinutes) {
+  int aEnd = a->endDay > a->startDay ? 24 * 60 : a->endMinute;
+  int bEnd = b->endDay > b->startDay ? 24 * 60 : b->endMinute;
+  if (aEnd < a->startMinute + minMinutes)
+    aEnd = a->startMinute + minMinutes;
+  if (bEnd < b->startMinute + minMinutes)
+    bEnd = b->startMinute + minMinutes;
+  return a->startMinute < bEnd && b->startMinute < aEnd;
+}
+
+static void test_random_invariants(void) {
+  EventLane out[64];
+  bool ok = true;
+  for (int round = 0; round < 200 && ok; round++) {
+    EventStore store = {0};
+    int n = 1 + random_below(40);
+    for (int i = 0; i < n; i++) {
+      int start = random_below(24 * 60);
+      add_timed(&store, start, start + random_below(180));
+    }
+    int minMinutes = random_below(30);
+    pack_all(&store, minMinutes, out);
+
+    for (int i = 0; i < n && ok; i++) {
+      ok = out[i].lane >= 0 && out[i].lane < out[i].laneCount;
+      for (int j = i + 1; j < n && ok; j++) {
+        if (!overlaps(&store.items[i], &store.items[j], minMinutes))
+          continue;
+        // Side by side, and sized as one cluster
+        ok = out[i].lane != out[j].lane &&
+             out[i].laneCount == out[j].laneCount;
+      }
+    }
+    if (!ok)
+      fprintf(stderr, "  round %d, %d events\n", round, n);
+    EventStore_Clear(&store);
+  }
+  CHECK(ok);
+}
+
+int main(void) {
+  test_clusters();
+  test_min_minutes();
+  test_random_invariants();
+  return CHECK_RESULT();
+}
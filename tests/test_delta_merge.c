@@ -0,0 +1,70 @@
+// Incremental sync merges: a delta lists changes anywhere in the calendar,
+// but each week window may only keep the events that fall in it.
+#include "check.h"
+#include "datetime.h"
+#include "events.h"
+
+#include <string.h>
+
+// Copies of event id in calendar 0's window
+static int count_in_window(const EventStore *store, const char *id,
+                           int window) {
+  int n = 0;
+  for (int i = 0; i < store->count; i++) {
+    if (store->items[i].calendarIndex == 0 &&
+        store->items[i].window == window &&
+        strcmp(store->details[i].id, id) == 0)
+      n++;
+  }
+  return n;
+}
+
+static void test_delta_moves_event_to_other_week(void) {
+  // Monday 2024-01-01 and the two weeks after it
+  int weekA = (int)DateTime_DaysFromCivil(2024, 1, 1);
+  int weekB = weekA + 7;
+  int weekC = weekA + 14;
+  EventStore store = {0};
+
+  CHECK(load_events_from_json(&store,
+                              "{\"items\":[{\"id\":\"moved\",\"summary\":\"A\","
+                              "\"start\":{\"date\":\"2024-01-03\"},"
+                              "\"end\":{\"date\":\"2024-01-04\"}}]}",
+                              0, weekA, false, NULL));
+  CHECK(load_events_from_json(&store,
+                              "{\"items\":[{\"id\":\"stays\",\"summary\":\"B\","
+                              "\"start\":{\"date\":\"2024-01-09\"},"
+                              "\"end\":{\"date\":\"2024-01-10\"}}]}",
+                              0, weekB, false, NULL));
+
+  // The same delta reaches both weeks: "moved" now sits in week B, and an
+  // event in week C was added
+  const char *delta =
+      "{\"items\":["
+      "{\"id\":\"moved\",\"summary\":\"A\","
+      "\"start\":{\"date\":\"2024-01-11\"},\"end\":{\"date\":\"2024-01-12\"}},"
+      "{\"id\":\"later\",\"summary\":\"C\","
+      "\"start\":{\"date\":\"2024-01-16\"},\"end\":{\"date\":\"2024-01-17\"}}"
+      "]}";
+  CHECK(load_events_from_json(&store, delta, 0, weekA, true, NULL));
+  CHECK(load_events_from_json(&store, delta, 0, weekB, true, NULL));
+
+  CHECK(count_in_window(&store, "moved", weekA) == 0);
+  CHECK(count_in_window(&store, "moved", weekB) == 1);
+  CHECK(count_in_window(&store, "stays", weekB) == 1);
+  CHECK(count_in_window(&store, "later", weekA) == 0);
+  CHECK(count_in_window(&store, "later", weekB) == 0);
+  CHECK(count_in_window(&store, "later", weekC) == 0);
+  CHECK(store.count == 2);
+
+  for (int i = 0; i < store.count; i++) {
+    if (strcmp(store.details[i].id, "moved") == 0)
+      CHECK(store.items[i].startDay == weekB + 3);
+  }
+  EventStore_Clear(&store);
+}
+
+int main(void) {
+  test_delta_moves_event_to_other_week();
+  return CHECK_RESULT();
+}
@@ -0,0 +1,175 @@
+// EventCache: what one run saves, the next loads back unchanged, and only
+// for the calendar list it was saved with.
+#include "check.h"
+#include "event_cache.h"
+#include "google_calendar.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char s_dir[64];
+
+static void add_event(EventStore *store, int calIndex, const char *summary,
+                      const char *description, const char *id, bool allDay) {
+  int i = EventStore_Append(store);
+  CalEvent *e = &store->items[i];
+  e->startTime = 1700000000 + i * 3600;
+  e->endTime = e->startTime + 1800;
+  e->summary = Arena_PushString(&store->arena, summary, strlen(summary));
+  e->summaryLength = (int32_t)strlen(summary);
+  e->startDay = 19676 + i;
+  e->endDay = allDay ? e->startDay + 2 : e->startDay;
+  e->startMinute = allDay ? 0 : (int16_t)(9 * 60 + i);
+  e->endMinute = allDay ? 0 : (int16_t)(9 * 60 + 30 + i);
+  e->colorId = i % 11;
+  e->calendarIndex = calIndex;
+  e->window = calIndex == 0 ? CAL_WINDOW_ALL : 19670;
+  e->allDay = allDay;
+  store->details[i] = (CalEventDetail){
+      Arena_PushString(&store->arena, description, strlen(description)),
+      Arena_PushString(&store->arena, "Room 4", 6),
+      Arena_PushString(&store->arena, id, strlen(id))};
+}
+
+static bool same_event(const EventStore *a, const EventStore *b, int i) {
+  const CalEvent *x = &a->items[i], *y = &b->items[i];
+  const CalEventDetail *dx = &a->details[i], *dy = &b->details[i];
+  return x->startTime == y->startTime && x->endTime == y->endTime &&
+         x->summaryLength == y->summaryLength &&
+         strcmp(x->summary, y->summary) == 0 &&
+         x->startDay == y->startDay && x->endDay == y->endDay &&
+         x->startMinute == y->startMinute && x->endMinute == y->endMinute &&
+         x->colorId == y->colorId && x->calendarIndex == y->calendarIndex &&
+         x->window == y->window && x->allDay == y->allDay &&
+         strcmp(dx->description, dy->description) == 0 &&
+         strcmp(dx->location, dy->location) == 0 &&
+         strcmp(dx->id, dy->id) == 0;
+}
+
+static bool same_calendar(const LinkedCalendar *a, const LinkedCalendar *b) {
+  return a->source == b->source && strcmp(a->name, b->name) == 0 &&
+         strcmp(a->calendarId, b->calendarId) == 0 &&
+         a->colorR == b->colorR && a->colorG == b->colorG &&
+         a->colorB == b->colorB && a->colorA == b->colorA &&
+         a->visible == b->visible;
+}
+
+static void test_round_trip(void) {
+  LinkedCalendar calendars[2] = {
+      {.name = "Holidays", .source = CAL_SOURCE_FILE,
+       .colorR = 10, .colorG = 20, .colorB = 30, .colorA = 255,
+       .visible = true},
+      {.name = "Work", .source = CAL_SOURCE_GOOGLE,
+       .colorR = 200, .colorG = 100, .colorB = 50, .colorA = 255,
+       .visible = false},
+  };
+  strcpy(calendars[0].filePath, "/home/me/holidays.ics");
+  strcpy(calendars[1].calendarId, "primary");
+
+  EventStore saved = {0};
+  add_event(&saved, 0, "New year", "", "", true);
+  add_event(&saved, 1, "Standup", "Daily, \"quick\"", "ev1", false);
+  add_event(&saved, 1, "", "No title", "ev2", false);
+  add_event(&saved, 1, "Caf\xc3\xa9", "", "ev3", false);
+  saved.utcOffset = 3600;
+
+  GoogleSyncState sync = {.weekStart = 19670, .lastUsed = 7,
+                          .etagUrl = 0x1234};
+  strcpy(sync.calendarId, "primary");
+  strcpy(sync.syncToken, "token-abc");
+  strcpy(sync.etag, "\"etag-1\"");
+  GoogleCalendar_ResetSync();
+  GoogleCalendar_RestoreSyncState(&sync);
+  CHECK(EventCache_Save(&saved, calendars, 2));
+
+  // Written through a temp file that doesn't outlive the save
+  char path[128];
+  snprintf(path, sizeof(path), "%s/fella/events.cache.tmp", s_dir);
+  CHECK(access(path, F_OK) != 0);
+
+  GoogleCalendar_ResetSync();
+  EventStore loaded = {0};
+  CHECK(EventCache_Load(&loaded, calendars, 2, true));
+  CHECK(loaded.count == saved.count);
+  CHECK(loaded.utcOffset == saved.utcOffset);
+  for (int i = 0; i < saved.count && i < loaded.count; i++)
+    CHECK(same_event(&saved, &loaded, i));
+
+  // The sync token came back with the events
+  GoogleSyncState states[4];
+  int n = GoogleCalendar_GetSyncStates(states, 4);
+  CHECK(n == 1);
+  CHECK(n == 1 && memcmp(&states[0], &sync, sizeof(sync)) == 0);
+
+  LinkedCalendar *list;
+  int count;
+  CHECK(EventCache_LoadCalendars(&list, &count));
+  CHECK(count == 2);
+  for (int i = 0; i < count && i < 2; i++)
+    CHECK(same_calendar(&list[i], &calendars[i]));
+  free(list);
+
+  // A different list, even just reordered, doesn't get these events
+  LinkedCalendar swapped[2] = {calendars[1], calendars[0]};
+  EventStore other = {0};
+  CHECK(!EventCache_Load(&other, swapped, 2, false));
+  CHECK(!EventCache_Load(&other, calendars, 1, false));
+  CHECK(other.count == 0);
+
+  // Saving again replaces the snapshot
+  EventStore_RemoveCalendar(&saved, 1);
+  CHECK(EventCache_Save(&saved, calendars, 2));
+  CHECK(EventCache_Load(&loaded, calendars, 2, false));
+  CHECK(loaded.count == 1);
+  CHECK(loaded.count == 1 && same_event(&saved, &loaded, 0));
+
+  EventStore_Clear(&saved);
+  EventStore_Clear(&loaded);
+  EventStore_Clear(&other);
+}
+
+static void test_missing_or_corrupt(void) {
+  char path[128];
+  snprintf(path, sizeof(path), "%s/fella/events.cache", s_dir);
+  LinkedCalendar *list;
+  int count;
+  EventStore store = {0};
+
+  remove(path);
+  CHECK(!EventCache_Load(&store, NULL, 0, false));
+  CHECK(!EventCache_LoadCalendars(&list, &count));
+  CHECK(list == NULL && count == 0);
+
+  FILE *f = fopen(path, "wb");
+  CHECK(f != NULL);
+  if (f) {
+    fputs("FELC garbage", f);
+    fclose(f);
+  }
+  CHECK(!EventCache_Load(&store, NULL, 0, false));
+  CHECK(!EventCache_LoadCalendars(&list, &count));
+  CHECK(store.count == 0);
+  remove(path);
+}
+
+int main(void) {
+  strcpy(s_dir, "/tmp/fella-test-XXXXXX");
+  if (!mkdtemp(s_dir)) {
+    perror("mkdtemp");
+    return 1;
+  }
+  setenv("XDG_CONFIG_HOME", s_dir, 1);
+
+  test_round_trip();
+  test_missing_or_corrupt();
+
+  char path[128];
+  snprintf(path, sizeof(path), "%s/fella/events.cache", s_dir);
+  remove(path);
+  snprintf(path, sizeof(path), "%s/fella", s_dir);
+  rmdir(path);
+  rmdir(s_dir);
+  return CHECK_RESULT();
+}
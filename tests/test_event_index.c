@@ -0,0 +1,150 @@
+// EventIndex_Query against a brute-force scan over random intervals, and
+// EventStore_QueryDays on top of it.
+#include "check.h"
+#include "datetime.h"
+#include "event_index.h"
+#include "events.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  int lo, hi, id;
+} Interval;
+
+static uint32_t s_rng = 12345;
+
+// xorshift32: fixed seed, so a failure reproduces
+static int random_below(int n) {
+  s_rng ^= s_rng << 13;
+  s_rng ^= s_rng >> 17;
+  s_rng ^= s_rng << 5;
+  return (int)(s_rng % (uint32_t)n);
+}
+
+static int compare_lo_id(const void *pa, const void *pb) {
+  const Interval *a = pa, *b = pb;
+  if (a->lo != b->lo)
+    return a->lo < b->lo ? -1 : 1;
+  return (a->id > b->id) - (a->id < b->id);
+}
+
+// Same overlap rule as the index: [lo, hi) and [qlo, qhi) share a point,
+// in (lo, id) order
+static int brute_query(const Interval *all, int n, int qlo, int qhi,
+                       Interval *out) {
+  int count = 0;
+  for (int i = 0; i < n; i++) {
+    if (all[i].lo < qhi && qlo < all[i].hi)
+      out[count++] = all[i];
+  }
+  qsort(out, (size_t)count, sizeof(Interval), compare_lo_id);
+  return count;
+}
+
+static bool query_matches(const EventIndex *idx, const Interval *all, int n,
+                          int qlo, int qhi, Interval *scratch) {
+  EventIndexResult result = {0};
+  EventIndex_Query(idx, qlo, qhi, &result);
+  int expected = brute_query(all, n, qlo, qhi, scratch);
+  bool ok = result.count == expected;
+  for (int i = 0; ok && i < expected; i++)
+    ok = result.items[i] == scratch[i].id;
+  free(result.items);
+  return ok;
+}
+
+static void test_random_against_scan(void) {
+  static const int sizes[] = {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 100, 1000, 4097};
+  Interval *all = malloc(sizeof(Interval) * 4097);
+  Interval *scratch = malloc(sizeof(Interval) * 4097);
+  if (!all || !scratch) {
+    CHECK(!"out of memory");
+    return;
+  }
+  EventIndex idx = {0};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    int n = sizes[s];
+    // Mostly short spans with some long ones and some empty ones, over a
+    // range that makes duplicates of lo common
+    EventIndex_Clear(&idx);
+    bool added = true;
+    for (int i = 0; i < n; i++) {
+      int lo = random_below(400) - 200;
+      int len = random_below(10) == 0 ? random_below(300) : random_below(4);
+      all[i] = (Interval){lo, lo + len, i};
+      added &= EventIndex_Add(&idx, lo, lo + len, i);
+    }
+    CHECK(added);
+    EventIndex_Build(&idx);
+
+    bool ok = true;
+    for (int q = 0; q < 300 && ok; q++) {
+      int qlo = random_below(700) - 350;
+      int qhi = qlo + random_below(20);
+      ok = query_matches(&idx, all, n, qlo, qhi, scratch);
+    }
+    // Everything, and nothing
+    ok = ok && query_matches(&idx, all, n, -100000, 100000, scratch);
+    ok = ok && query_matches(&idx, all, n, 100000, 100001, scratch);
+    CHECK(ok);
+    if (!ok)
+      fprintf(stderr, "  with %d intervals\n", n);
+  }
+  EventIndex_Free(&idx);
+  free(all);
+  free(scratch);
+}
+
+static int add_event(EventStore *store, int startDay, int endDay, bool allDay) {
+  int i = EventStore_Append(store);
+  store->items[i].startDay = startDay;
+  store->items[i].endDay = endDay;
+  store->items[i].allDay = allDay;
+  return i;
+}
+
+static bool result_is(const EventIndexResult *r, const int *ids, int n) {
+  if (r->count != n)
+    return false;
+  for (int i = 0; i < n; i++) {
+    if (r->items[i] != ids[i])
+      return false;
+  }
+  return true;
+}
+
+static void test_store_query_days(void) {
+  int monday = (int)DateTime_DaysFromCivil(2024, 1, 1);
+  EventStore store = {0};
+  int before = add_event(&store, monday - 3, monday + 1, true); // Fri-Mon
+  int timed = add_event(&store, monday + 2, monday + 2, false);
+  // A timed event ending the next day only shows on its start day
+  int overnight = add_event(&store, monday + 6, monday + 7, false);
+  int allDayEnds = add_event(&store, monday - 1, monday, true); // Sunday only
+  int nextWeek = add_event(&store, monday + 7, monday + 8, true);
+  (void)allDayEnds;
+  (void)nextWeek;
+
+  EventIndexResult r = {0};
+  EventStore_QueryDays(&store, monday, monday + 7, &r);
+  int expected[] = {before, timed, overnight};
+  CHECK(result_is(&r, expected, 3));
+
+  // A change to the store rebuilds the index on the next query
+  int added = add_event(&store, monday + 3, monday + 5, true);
+  r.count = 0;
+  EventStore_QueryDays(&store, monday, monday + 7, &r);
+  int expectedAfter[] = {before, timed, added, overnight};
+  CHECK(result_is(&r, expectedAfter, 4));
+
+  free(r.items);
+  EventStore_Clear(&store);
+}
+
+int main(void) {
+  test_random_against_scan();
+  test_store_query_days();
+  return CHECK_RESULT();
+}
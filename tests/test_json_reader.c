@@ -0,0 +1,156 @@
+// The pull reader the event parser runs on: tokens, string decoding and
+// partial input, including the page-token peek at a response still
+// downloading.
+#include "check.h"
+#include "events.h"
+#include "json_reader.h"
+
+#include <string.h>
+
+// Decode the first token of json, which must be a string
+static bool decodes_to(const char *json, const char *expected,
+                       size_t expectedLength) {
+  JsonReader r;
+  JsonToken tok;
+  char out[64];
+  JsonReader_Init(&r, json, strlen(json));
+  if (JsonReader_Next(&r, &tok) != JSON_TOK_STRING || tok.length >= sizeof(out))
+    return false;
+  size_t n = JsonToken_DecodeString(&tok, out);
+  return n == expectedLength && memcmp(out, expected, n) == 0 &&
+         out[n] == '\0' && n <= tok.length;
+}
+
+static void test_tokens(void) {
+  const char *json =
+      "{\"a\": [1, -2.5e3, true, false, null], \"b\": {\"c\": \"d\"}}";
+  static const JsonTokenType expected[] = {
+      JSON_TOK_OBJECT_BEGIN, JSON_TOK_STRING,     JSON_TOK_ARRAY_BEGIN,
+      JSON_TOK_NUMBER,       JSON_TOK_NUMBER,     JSON_TOK_TRUE,
+      JSON_TOK_FALSE,        JSON_TOK_NULL,       JSON_TOK_ARRAY_END,
+      JSON_TOK_STRING,       JSON_TOK_OBJECT_BEGIN, JSON_TOK_STRING,
+      JSON_TOK_STRING,       JSON_TOK_OBJECT_END, JSON_TOK_OBJECT_END,
+      JSON_TOK_END,
+  };
+  JsonReader r;
+  JsonToken tok;
+  JsonReader_Init(&r, json, strlen(json));
+  int n = (int)(sizeof(expected) / sizeof(expected[0]));
+  for (int i = 0; i < n; i++) {
+    JsonTokenType type = JsonReader_Next(&r, &tok);
+    CHECK(type == expected[i]);
+    if (i == 4)
+      CHECK(tok.length == 6 && memcmp(tok.start, "-2.5e3", 6) == 0);
+    if (i == 9)
+      CHECK(JsonToken_Equals(&tok, "b") && !JsonToken_Equals(&tok, "bb"));
+  }
+}
+
+static void test_skip(void) {
+  const char *json = "{\"skip\": {\"x\": [1, {\"y\": \"]}\"}], \"z\": {}}, "
+                     "\"keep\": 7}";
+  JsonReader r;
+  JsonToken key, val;
+  JsonReader_Init(&r, json, strlen(json));
+  CHECK(JsonReader_Next(&r, &key) == JSON_TOK_OBJECT_BEGIN);
+  CHECK(JsonReader_Next(&r, &key) == JSON_TOK_STRING);
+  CHECK(JsonReader_Next(&r, &val) == JSON_TOK_OBJECT_BEGIN);
+  CHECK(JsonReader_SkipValue(&r, &val));
+  CHECK(JsonReader_Next(&r, &key) == JSON_TOK_STRING &&
+        JsonToken_Equals(&key, "keep"));
+  CHECK(JsonReader_Next(&r, &val) == JSON_TOK_NUMBER && val.length == 1);
+  // Scalars skip as a no-op
+  CHECK(JsonReader_SkipValue(&r, &val));
+  CHECK(JsonReader_Next(&r, &key) == JSON_TOK_OBJECT_END);
+}
+
+static void test_escapes(void) {
+  CHECK(decodes_to("\"plain\"", "plain", 5));
+  CHECK(decodes_to("\"a\\nb\\tc\\rd\\be\\ff\"", "a\nb\tc\rd\be\ff", 11));
+  CHECK(decodes_to("\"q\\\"uote\\\\ \\/\"", "q\"uote\\ /", 9));
+  // An escaped quote doesn't end the string
+  CHECK(decodes_to("\"\\\"\"", "\"", 1));
+  CHECK(decodes_to("\"caf\\u00e9\"", "caf\xC3\xA9", 5));
+  CHECK(decodes_to("\"\\u20AC\"", "\xE2\x82\xAC", 3));
+  CHECK(decodes_to("\"\\u0041\"", "A", 1));
+  // Surrogate pair -> one 4-byte sequence
+  CHECK(decodes_to("\"\\ud83d\\ude00!\"", "\xF0\x9F\x98\x80!", 5));
+  CHECK(decodes_to("\"\\uD834\\uDD1E\"", "\xF0\x9D\x84\x9E", 4));
+  // A high surrogate without its low half is kept as its own code point
+  CHECK(decodes_to("\"\\ud83dx\"", "\xED\xA0\xBDx", 4));
+  // Malformed \u escapes are dropped rather than read past
+  CHECK(decodes_to("\"a\\u12\"", "a12", 3));
+}
+
+static void test_truncated(void) {
+  JsonReader r;
+  JsonToken tok;
+  const char *json = "{\"a\": \"unterminated";
+  JsonReader_Init(&r, json, strlen(json));
+  CHECK(JsonReader_Next(&r, &tok) == JSON_TOK_OBJECT_BEGIN);
+  CHECK(JsonReader_Next(&r, &tok) == JSON_TOK_STRING);
+  CHECK(JsonReader_Next(&r, &tok) == JSON_TOK_ERROR);
+
+  // The length bounds the reader, not the terminator: a string cut off by
+  // it is an error, and nothing past it is read
+  const char *full = "{\"key\": \"value\"}";
+  JsonReader_Init(&r, full, 12);
+  CHECK(JsonReader_Next(&r, &tok) == JSON_TOK_OBJECT_BEGIN);
+  CHECK(JsonReader_Next(&r, &tok) == JSON_TOK_STRING);
+  CHECK(JsonReader_Next(&r, &tok) == JSON_TOK_ERROR);
+
+  const char *open = "[1, [2, {\"x\": 3";
+  JsonReader_Init(&r, open, strlen(open));
+  CHECK(JsonReader_Next(&r, &tok) == JSON_TOK_ARRAY_BEGIN);
+  CHECK(!JsonReader_SkipValue(&r, &tok));
+
+  JsonReader_Init(&r, "tru", 3);
+  CHECK(JsonReader_Next(&r, &tok) == JSON_TOK_ERROR);
+  JsonReader_Init(&r, "", 0);
+  CHECK(JsonReader_Next(&r, &tok) == JSON_TOK_END);
+}
+
+static void test_peek_page_token(void) {
+  char token[CAL_SYNC_TOKEN_LEN];
+  size_t size = sizeof(token);
+  const char *json = "{\"kind\": \"calendar#events\", \"nextPageToken\": "
+                     "\"CiAKGjBp\\u003d\", \"items\": [{\"id\": \"x\"}]}";
+  size_t len = strlen(json);
+
+  CHECK(events_peek_page_token(json, len, token, size) &&
+        strcmp(token, "CiAKGjBp=") == 0);
+  // Every prefix either can't tell yet or already has the whole token
+  bool prefixesOk = true;
+  for (size_t cut = 0; cut < len; cut++) {
+    strcpy(token, "stale");
+    if (events_peek_page_token(json, cut, token, size))
+      prefixesOk &= strcmp(token, "CiAKGjBp=") == 0;
+  }
+  CHECK(prefixesOk);
+  size_t tokenEnd = (size_t)(strstr(json, "\\u003d\"") + 7 - json);
+  CHECK(!events_peek_page_token(json, tokenEnd - 1, token, size));
+  CHECK(events_peek_page_token(json, tokenEnd, token, size));
+
+  // Last page: no token anywhere
+  const char *last = "{\"nextSyncToken\": \"s\"}";
+  CHECK(events_peek_page_token(last, strlen(last), token, size) &&
+        token[0] == '\0');
+  CHECK(!events_peek_page_token(last, strlen(last) - 1, token, size));
+
+  // Items first: only the full parse can tell
+  const char *itemsFirst = "{\"items\": [], \"nextPageToken\": \"p\"}";
+  CHECK(!events_peek_page_token(itemsFirst, strlen(itemsFirst), token, size));
+
+  // Too long to hold is left to the full parse, never reported as "none"
+  const char *longToken = "{\"nextPageToken\": \"0123456789\"}";
+  CHECK(!events_peek_page_token(longToken, strlen(longToken), token, 8));
+}
+
+int main(void) {
+  test_tokens();
+  test_skip();
+  test_escapes();
+  test_truncated();
+  test_peek_page_token();
+  return CHECK_RESULT();
+}